@@ -18,11 +18,13 @@
 #include "src/ui_toolbox.h"
 
 #include "FastLED.h"
-#define NUM_LEDS       16
-#define LED_PIN        5
-#define LED_BRIGHTNESS 64
 #define LCD_BRIGHTNESS 255
 
+// Draw the keys from a bitmap rather than as buttons, which makes for a
+// much smaller display list. Comment out to compare, the DLCache debug
+// messages report the size of each octave strip.
+#define USE_KEYBOARD_BITMAPS
+
 // Margin around the buttons
 #define MARGIN_T  10
 #define MARGIN_B  10
@@ -31,252 +33,505 @@ constexpr int16_t  font_small    = 28;
 constexpr int16_t  font_medium   = 29;
 constexpr int16_t  font_large    = 31;
 
+/****************************** KEYBOARD LAYOUT *****************************/
+
+/* The keyboard spans the full range of the FT810 synthesizer, from A0 to C8,
+ * and scrolls sideways to show two octaves at a time. Each octave is laid out
+ * as a strip of its own starting at x = 0 and is cached in RAM_G the first
+ * time it is drawn, so scrolling only changes the VERTEX_TRANSLATE_X in front
+ * of each cached strip. This also keeps the key coordinates well within the
+ * range of VERTEX2F, which the full keyboard would not fit in.
+ */
+
+#define KEYBOARD_VISIBLE_WHITES  14
+#define KEYBOARD_STRIPS           9  // A0 to B0, seven full octaves, then C8
+
+constexpr uint8_t  keyboard_dl_slot = 1;   // First DLCache slot for the strips
+
+constexpr uint16_t white_key_w      = display_width / KEYBOARD_VISIBLE_WHITES;
+constexpr int16_t  scrollbar_y      = display_height * 3 / 8;
+constexpr int16_t  scrollbar_h      = display_height / 16;
+constexpr int16_t  keyboard_y       = scrollbar_y + scrollbar_h;
+constexpr int16_t  keyboard_w       = 52 * white_key_w;
+constexpr int16_t  keyboard_scroll_max = keyboard_w - KEYBOARD_VISIBLE_WHITES * white_key_w;
+
+template<uint8_t FIRST, uint8_t KEYS, uint8_t WHITES>
+struct KeyStrip {
+  static constexpr uint8_t first_note   = FIRST;
+  static constexpr uint8_t num_keys     = KEYS;
+  static constexpr int16_t x            = 0;
+  static constexpr int16_t y            = keyboard_y;
+  static constexpr int16_t w            = WHITES * white_key_w;
+  static constexpr int16_t h            = display_height - keyboard_y;
+  static constexpr uint8_t black_width  = 100;
+  static constexpr uint8_t black_height = 60;
+  static constexpr uint8_t margin       = 3;
+};
+
+typedef KeyboardLayout<KeyStrip<NOTE_A0, 3,  2>> LowKeys;
+typedef KeyboardLayout<KeyStrip<NOTE_C1, 12, 7>> OctaveKeys;
+typedef KeyboardLayout<KeyStrip<NOTE_C8, 1,  1>> TopKeys;
+
+/**************************** INSTRUMENTS AND SONGS ***************************/
+
+/* The instrument and song buttons are generated from the tables below.
+ * Each table gets a range of tags (see TAGS below) in the same order, so
+ * finding out what a button does takes constant time, and adding an
+ * instrument or a song is a matter of adding a row and finding a free
+ * spot on the grid.
+ */
+
+typedef struct {
+  uint8_t  col, row, width;  // Position of the button on the grid
+  char     label[13];
+  uint8_t  effect;           // The effect_t to play on the keys
+  bool     drums;            // Or, play the pads of the selected drum kit
+} instrument_t;
+
+typedef struct {
+  char                        label[13];
+  const SoundPlayer::sound_t *sequence;
+} song_t;
+
+const instrument_t instruments[] PROGMEM = {
+  // col row width label           effect        drums
+  {1, 1, 2, "Piano",         PIANO,        false},
+  {1, 2, 2, "Organ",         ORGAN,        false},
+  {1, 3, 2, "Harp",          HARP,         false},
+  {7, 1, 3, "Xylophone",     XYLOPHONE,    false},
+  {7, 2, 3, "Glockenspeil",  GLOCKENSPIEL, false},
+  {3, 3, 2, "Sine",          SINE_WAVE,    false},
+  {3, 1, 2, "Tuba",          TUBA,         false},
+  {5, 2, 2, "Trumpet",       TRUMPET,      false},
+  {5, 3, 2, "Music Box",     MUSIC_BOX,    false},
+  {5, 1, 2, "Chimes",        CHIMES,       false},
+  {3, 2, 2, "Bell",          BELL,         false},
+  {7, 3, 2, "Drum Kit",      HIHAT,        true},
+};
+
+constexpr uint8_t num_instruments = sizeof(instruments) / sizeof(instruments[0]);
+
+// See "src/ui_sounds.h" for the sound sequences
+
+const song_t songs[] PROGMEM = {
+  // label
+  {"Chimes",       chimes},
+  {"Sad Trombone", sad_trombone},
+  {"Twinkle",      twinkle},
+  {"Fanfare",      fanfare},
+  {"USB In",       media_inserted},
+  {"USB Out",      media_removed},
+  {"Bach Toccata", js_bach_toccata},
+  {"Bach Joy",     js_bach_joy},
+  {"Big Band",     big_band},
+  {"Beeping",      beeping},
+  {"Alarm",        alarm},
+  {"Warble",       warble},
+  {"Carousel",     carousel},
+  {"Beats",        beats},
+};
+
+constexpr uint8_t num_songs = sizeof(songs) / sizeof(songs[0]);
+
+/************************************ TAGS ************************************/
+
+// The piano screen
+
+constexpr TagRange key_tags        = TagRange::first_range(NOTE_C8 - NOTE_A0 + 1); // A0 to C8
+constexpr TagRange instrument_tags = key_tags.next(num_instruments);
+constexpr TagRange songs_tag       = instrument_tags.next(1);
+constexpr TagRange volume_tag      = songs_tag.next(1);
+constexpr TagRange scroll_tag      = volume_tag.next(1);
+
+static_assert(UI::tags_valid(key_tags, instrument_tags, songs_tag, volume_tag, scroll_tag), "Piano screen tags overlap or run out");
+
+struct PianoTags {
+  enum : uint8_t {none, key, instrument, songs, volume, scroll};
+
+  static constexpr uint8_t widget_of(uint8_t tag) {
+    return key_tags.contains(tag)        ? key        :
+           instrument_tags.contains(tag) ? instrument :
+           songs_tag.contains(tag)       ? songs      :
+           volume_tag.contains(tag)      ? volume     :
+           scroll_tag.contains(tag)      ? scroll     : none;
+  }
+};
+
+typedef TagMap<PianoTags> PianoTagMap;
+
+// The songs screen
+
+constexpr TagRange back_tag  = TagRange::first_range(1);
+constexpr TagRange song_tags = back_tag.next(num_songs);
+constexpr TagRange beat_tag  = song_tags.next(1);
+
+static_assert(UI::tags_valid(back_tag, song_tags, beat_tag), "Songs screen tags overlap or run out");
+
+struct SongTags {
+  enum : uint8_t {none, back, song, beat};
+
+  static constexpr uint8_t widget_of(uint8_t tag) {
+    return back_tag.contains(tag)  ? back :
+           song_tags.contains(tag) ? song :
+           beat_tag.contains(tag)  ? beat : none;
+  }
+};
+
+typedef TagMap<SongTags> SongTagMap;
+
 /****************************** SCREEN DECLARATIONS *****************************/
 
 class PianoScreen : public InterfaceScreen {
   private:
-    static effect_t instrument;
-    static uint8_t  volume;
+    // Kept on the screen stack while the songs screen is showing
+    static struct state_t {
+      uint8_t  volume;
+      uint8_t  highlighted_instrument;
+      uint16_t scroll_x;
+    } state;
+
     static uint8_t  highlighted_note;
-    static uint8_t  highlighted_instrument;
-    static CRGB     leds[NUM_LEDS];
+    static uint8_t  song_led_key;   // LED key lit by the song playing, or 0xFF
+    static uint32_t held_led_keys;  // LED keys held down on the touch panel
+    static uint8_t  key_ripple;     // LedAnimator id of the held key's ripple
+    static bool     background_cached;
+    static uint8_t  instrument_font[num_instruments];
 
-    static void buttonStyleCallback(uint8_t tag, uint8_t &style, uint16_t &options, bool post);
+    static const button_style_t button_styles[];
     static uint32_t getNoteColor(uint8_t tag);
+
+    static note_t  getNote(uint8_t tag) {return note_t(NOTE_A0 + key_tags.index(tag));}
+    static uint8_t getStrip(uint8_t tag);
+    static void    drawStrip(CommandProcessor &cmd, uint8_t strip);
+    static void    drawKeyboard(CommandProcessor &cmd);
+    static void    playKey(uint8_t tag);
+    static void    drawBackground(CommandProcessor &cmd);
+    static void    fitLabels();
   public:
+    static constexpr uint8_t inputProfile = MUSICAL_INPUT_PROFILE;
+    static constexpr uint8_t stateSize    = sizeof(state_t);
+    static void *stateData() {return &state;}
+
     static void onEntry();
     static void onExit();
     static void onRedraw(draw_mode_t what);
-    static void onTouchStart(uint8_t tag);
+    static bool onTouchStart(uint8_t tag);
+    static bool onTouchEnd(uint8_t tag);
     static void onIdle();
+
+    // Only the keys are slid across, for a glissando
+    static bool isSlideTag(uint8_t tag) {return key_tags.contains(tag);}
+
+    static void onNoteEvent(effect_t effect, note_t note, uint16_t duration_ms);
 };
 
 class SongsScreen : public InterfaceScreen {
+  private:
+    static void fitLabels();
   public:
+    static void onEntry();
     static void onRedraw(draw_mode_t what);
-    static void onTouchEnd(uint8_t tag);
+    static bool onTouchEnd(uint8_t tag);
 };
 
-SCREEN_TABLE {
-  DECL_SCREEN(PianoScreen),
-  DECL_SCREEN(SongsScreen)
-};
-SCREEN_TABLE_POST
+SCREEN_TABLE(PianoScreen, SongsScreen)
 
 /***************************** PIANO SCREEN *****************************/
 
-static effect_t PianoScreen::instrument;
-static uint8_t  PianoScreen::volume;
-static uint8_t  PianoScreen::highlighted_instrument;
+PianoScreen::state_t PianoScreen::state;
 static uint8_t  PianoScreen::highlighted_note;
-static CRGB     PianoScreen::leds[NUM_LEDS];
+static uint8_t  PianoScreen::song_led_key = 0xFF;
+static uint32_t PianoScreen::held_led_keys;
+static uint8_t  PianoScreen::key_ripple;
+static bool     PianoScreen::background_cached;
+static uint8_t  PianoScreen::instrument_font[num_instruments];
+
+// The keys are colored by drawStrip(), so only the buttons above need styles
+const button_style_t PianoScreen::button_styles[] PROGMEM = {
+  // first tag              last tag                rgb       selected rgb  selected tag
+  {instrument_tags.first,   instrument_tags.last(), 0x000000, 0x888888,     &PianoScreen::state.highlighted_instrument},
+  {songs_tag.first,         songs_tag.last(),       0x000000, 0x000000,     NULL}
+};
 
 constexpr uint16_t dial_min = 4095;
 constexpr uint16_t dial_max = 0xFFFF - dial_min;
 
+const ControlMap volume_map(dial_min, dial_max, 255, 2);
+const ControlMap scroll_map(0, 0xFFFF, keyboard_scroll_max, 2);
+
+// While only the dial is changing, the rest of the screen is appended
+// from a copy in RAM_G. This reserves enough room for it to grow.
+constexpr uint8_t  background_dl_slot = keyboard_dl_slot + KEYBOARD_STRIPS;
+constexpr uint16_t background_dl_size = 4096;
+
 enum {
   black  = 0x000000,
-  red    = 0xFF0000,
-  orange = 0xFF7F00,
-  yellow = 0xFFFF00,
-  green  = 0x00FF00,
-  blue   = 0x0000FF,
-  indigo = 0x4B0082,
-  violet = 0x9400D3,
   white  = 0xFFFFFF
 };
 
 void PianoScreen::onEntry() {
-  instrument = PIANO;
-  volume     = 255;
-  highlighted_instrument = 241;
+  // Coming back from the songs screen, carry on where the user left off
+  if(!current_screen.restored()) {
+    state.volume                 = 255;
+    state.highlighted_instrument = instrument_tags.first;
+    state.scroll_x               = 16 * white_key_w; // Start at C3, sixteen white keys above A0
+  }
   
   InterfaceScreen::onEntry();
-  sound.set_volume(volume);
+  #if defined(USE_KEYBOARD_BITMAPS)
+    KeyboardBitmaps::load();
+  #endif
+  sound.set_volume(state.volume);
   UIData::enable_touch_sounds(false);
 
   CLCD::turn_on_backlight();
   CLCD::set_brightness(LCD_BRIGHTNESS);
 
-  CommandProcessor cmd;
-  cmd.set_button_style_callback(buttonStyleCallback);
+  fitLabels();
 
-  FastLED.addLeds<NEOPIXEL, LED_PIN>(leds, NUM_LEDS);
-  FastLED.setBrightness( LED_BRIGHTNESS );
+  CommandProcessor cmd;
+  cmd.set_button_style_rules(button_styles);
 }
 
 void PianoScreen::onExit() {
   InterfaceScreen::onExit();
   CommandProcessor cmd;
-  cmd.set_button_style_callback(NULL);
+  cmd.set_button_style_rules(NULL, 0);
+  LedAnimator::clear();
+  held_led_keys = 0;
+  song_led_key  = 0xFF;
+  // Undo the scaling of the last key, so songs play at the chosen volume
+  sound.set_volume(state.volume);
 }
 
+#define MARGIN_L  3
+#define MARGIN_R  3
+#define MARGIN_T  3
+#define MARGIN_B  3
+
 void PianoScreen::onRedraw(draw_mode_t what) {
   CommandProcessor cmd;
+
+  // The background is only cached once a redraw of the dial alone is
+  // asked for, so that playing notes does not wait on the cache.
+  DLCache dlcache(background_dl_slot);
+  if(what & BACKGROUND) {
+    drawBackground(cmd);
+    background_cached = false;
+  } else if(background_cached) {
+    dlcache.append();
+  } else {
+    drawBackground(cmd);
+    background_cached = dlcache.store(background_dl_size);
+  }
+
+  if(what & FOREGROUND) {
+    #define GRID_ROWS 8
+    #define GRID_COLS 12
+    cmd.fgcolor(0x111111)
+       .tag(volume_tag.first).dial(BTN_POS(10,1), BTN_SIZE(3,3), volume_map.to_tracker(state.volume));
+    #undef GRID_ROWS
+    #undef GRID_COLS
+  }
+}
+
+void PianoScreen::drawBackground(CommandProcessor &cmd) {
   cmd.cmd(CLEAR_COLOR_RGB(0x222222))
      .cmd(CLEAR(true,true,true));
 
-  #define MARGIN_L  3
-  #define MARGIN_R  3
-  #define MARGIN_T  3
-  #define MARGIN_B  3
-  
   #define GRID_ROWS 8
   #define GRID_COLS 12
-  cmd.font(font_small)
-     .fgcolor(0x111111)
-     .tag(241).button( BTN_POS(1,1), BTN_SIZE(2,1), F("Piano"))
-     .tag(242).button( BTN_POS(1,2), BTN_SIZE(2,1), F("Organ"))
-     .tag(243).button( BTN_POS(1,3), BTN_SIZE(2,1), F("Harp"))
-
-     .tag(247).button( BTN_POS(3,1), BTN_SIZE(2,1), F("Tuba"))
-     .tag(251).button( BTN_POS(3,2), BTN_SIZE(2,1), F("Bell"))     
-     .tag(246).button( BTN_POS(3,3), BTN_SIZE(2,1), F("Sine"))
-
-     .tag(250).button( BTN_POS(5,1), BTN_SIZE(2,1), F("Chimes"))
-     .tag(248).button( BTN_POS(5,2), BTN_SIZE(2,1), F("Trumpet"))
-     .tag(249).button( BTN_POS(5,3), BTN_SIZE(2,1), F("Music Box"))
-
-     .tag(244).button( BTN_POS(7,1), BTN_SIZE(3,1), F("Xylophone"))
-     .tag(245).button( BTN_POS(7,2), BTN_SIZE(3,1), F("Glockenspeil"))
-     .tag(252).button( BTN_POS(7,3), BTN_SIZE(2,1), F("Drum Kit"))
-     .tag(239).button( BTN_POS(9,3), BTN_SIZE(1,1), F("..."))
-     .tag(240).dial  ( BTN_POS(10,1), BTN_SIZE(3,3), dial_min + (dial_max - dial_min) / 255 * volume);
-
-  #define NUM_OCTAVES 2
-  #undef  GRID_COLS
-  #define GRID_COLS (NUM_OCTAVES*14)
-
-  for(int octave = 0; octave < NUM_OCTAVES; octave++) {
-    cmd.fgcolor(white)
-       .tag(octave*12 + 1) .button( BTN_POS(octave*14 + 1,4),  BTN_SIZE(2,5), F(""), OPT_FLAT)
-       .tag(octave*12 + 3) .button( BTN_POS(octave*14 + 3,4),  BTN_SIZE(2,5), F(""), OPT_FLAT)
-       .tag(octave*12 + 5) .button( BTN_POS(octave*14 + 5,4),  BTN_SIZE(2,5), F(""), OPT_FLAT)
-       .tag(octave*12 + 6) .button( BTN_POS(octave*14 + 7,4),  BTN_SIZE(2,5), F(""), OPT_FLAT)
-       .tag(octave*12 + 8) .button( BTN_POS(octave*14 + 9,4),  BTN_SIZE(2,5), F(""), OPT_FLAT)
-       .tag(octave*12 + 10).button( BTN_POS(octave*14 + 11,4), BTN_SIZE(2,5), F(""), OPT_FLAT)
-       .tag(octave*12 + 12).button( BTN_POS(octave*14 + 13,4), BTN_SIZE(2,5), F(""), OPT_FLAT);
-  
-    cmd.fgcolor(black)
-       .tag(octave*12 + 2) .button( BTN_POS(octave*14 + 2,4),  BTN_SIZE(2,3), F(""), OPT_FLAT)
-       .tag(octave*12 + 4) .button( BTN_POS(octave*14 + 4,4),  BTN_SIZE(2,3), F(""), OPT_FLAT)
-       .tag(octave*12 + 7) .button( BTN_POS(octave*14 + 8,4),  BTN_SIZE(2,3), F(""), OPT_FLAT)
-       .tag(octave*12 + 9) .button( BTN_POS(octave*14 + 10,4), BTN_SIZE(2,3), F(""), OPT_FLAT)
-       .tag(octave*12 + 11).button( BTN_POS(octave*14 + 12,4), BTN_SIZE(2,3), F(""), OPT_FLAT);
+  cmd.fgcolor(0x111111);
+
+  for(uint8_t i = 0; i < num_instruments; i++) {
+    const uint8_t col   = pgm_read_byte(&instruments[i].col);
+    const uint8_t row   = pgm_read_byte(&instruments[i].row);
+    const uint8_t width = pgm_read_byte(&instruments[i].width);
+    cmd.font(instrument_font[i])
+       .tag(instrument_tags[i]).button(BTN_POS(col,row), BTN_SIZE(width,1), (progmem_str) instruments[i].label);
   }
-  
+
+  cmd.font(font_small)
+     .tag(songs_tag.first).button( BTN_POS(9,3), BTN_SIZE(1,1), F("..."));
+
+  #undef GRID_ROWS
   #undef GRID_COLS
+
+  cmd.tag(scroll_tag.first).scrollbar(0, scrollbar_y, display_width, scrollbar_h,
+    state.scroll_x, KEYBOARD_VISIBLE_WHITES * white_key_w, keyboard_w);
+
+  drawKeyboard(cmd);
 }
 
-uint32_t PianoScreen::getNoteColor(uint8_t tag) {
-  switch(tag % 12) {
-    case 1:  return red;                 // C
-    case 2:  return (red + orange)/2;    // C#
-    case 3:  return orange;              // D
-    case 4:  return (orange + yellow)/2; // D#
-    case 5:  return yellow;              // E
-    case 6:  return green;               // F
-    case 7:  return (green + blue)/2;    // F#
-    case 8:  return blue;                // G
-    case 9:  return (blue + indigo)/2;   // G#
-    case 10: return indigo;              // A
-    case 11: return (indigo + violet)/2; // A#
-    case 0:  return violet;              // B
+// Picks the largest font for each instrument label. The layout never
+// changes, so this is only done the first time the screen is entered.
+void PianoScreen::fitLabels() {
+  if(instrument_font[0]) return;
+
+  #define GRID_ROWS 8
+  #define GRID_COLS 12
+  for(uint8_t i = 0; i < num_instruments; i++) {
+    const uint8_t width = pgm_read_byte(&instruments[i].width);
+    instrument_font[i] = FontCache::fit_font((progmem_str) instruments[i].label, BTN_SIZE(width,1), font_medium, font_small - 2);
   }
+  #undef GRID_ROWS
+  #undef GRID_COLS
 }
 
-void PianoScreen::buttonStyleCallback(uint8_t tag, uint8_t &style, uint16_t &options, bool post) {
-  CommandProcessor cmd;
+// Returns the strip holding a key, the first strip being A0 to B0
+uint8_t PianoScreen::getStrip(uint8_t tag) {
+  const note_t note = getNote(tag);
+  return note < NOTE_C1 ? 0 : note >= NOTE_C8 ? KEYBOARD_STRIPS - 1 : (note - NOTE_C1) / 12 + 1;
+}
 
-  // Highlight the selected instrument
-  if(tag > 240) {
-    if(tag == highlighted_instrument) {
-      cmd.fgcolor(0x888888);
-    } else {
-      cmd.fgcolor(0x000000);
+void PianoScreen::drawStrip(CommandProcessor &cmd, uint8_t strip) {
+  const uint32_t highlight = highlighted_note ? getNoteColor(highlighted_note) : 0;
+  #if defined(USE_KEYBOARD_BITMAPS)
+    switch(strip) {
+      case 0:                   LowKeys::draw_bitmaps(cmd, key_tags.first, highlighted_note, highlight, white, black); break;
+      case KEYBOARD_STRIPS - 1: TopKeys::draw_bitmaps(cmd, key_tags[NOTE_C8 - NOTE_A0], highlighted_note, highlight, white, black); break;
+      default:                  OctaveKeys::draw_bitmaps(cmd, key_tags[NOTE_C1 + (strip - 1) * 12 - NOTE_A0], highlighted_note, highlight, white, black); break;
     }
-  } else {
-    // Hightlight the note that is playing
-    if(tag == highlighted_note) {
-      cmd.fgcolor(getNoteColor(tag));
+  #else
+    switch(strip) {
+      case 0:                   LowKeys::draw(cmd, key_tags.first, highlighted_note, highlight, white, black); break;
+      case KEYBOARD_STRIPS - 1: TopKeys::draw(cmd, key_tags[NOTE_C8 - NOTE_A0], highlighted_note, highlight, white, black); break;
+      default:                  OctaveKeys::draw(cmd, key_tags[NOTE_C1 + (strip - 1) * 12 - NOTE_A0], highlighted_note, highlight, white, black); break;
+    }
+  #endif
+}
+
+void PianoScreen::drawKeyboard(CommandProcessor &cmd) {
+  for(uint8_t strip = 0; strip < KEYBOARD_STRIPS; strip++) {
+    const int16_t strip_x = (strip == 0 ? 0 : (2 + (strip - 1) * 7) * white_key_w) - state.scroll_x;
+    const int16_t strip_w = (strip == 0 ? 2 : strip == KEYBOARD_STRIPS - 1 ? 1 : 7) * white_key_w;
+    if(strip_x + strip_w <= 0 || strip_x >= display_width) continue;
+
+    cmd.cmd(VERTEX_TRANSLATE_X(uint32_t(strip_x) * 16));
+
+    // The strip holding the highlighted key is drawn live, so it
+    // shows the highlight; all others come out of the cache.
+    DLCache dlcache(keyboard_dl_slot + strip);
+    if(highlighted_note && getStrip(highlighted_note) == strip) {
+      drawStrip(cmd, strip);
+    } else if(dlcache.has_data()) {
+      dlcache.append();
     } else {
-      switch(tag % 12) {
-        case 0:
-        case 1:
-        case 3:
-        case 5:
-        case 6:
-        case 8:
-        case 10:
-          cmd.fgcolor(white);
-          break;
-        default:
-          cmd.fgcolor(black);
-          break;
-      }
+      dlcache.begin_segment();
+      drawStrip(cmd, strip);
+      dlcache.store();
     }
   }
+  cmd.cmd(VERTEX_TRANSLATE_X(0));
+}
+
+uint32_t PianoScreen::getNoteColor(uint8_t tag) {
+  return NoteColors::lcd(getNote(tag));
 }
 
-void PianoScreen::onTouchStart(uint8_t tag) {
+bool PianoScreen::onTouchStart(uint8_t tag) {
   CommandProcessor cmd;
-  switch(tag) {
-    case 239: GOTO_SCREEN(SongsScreen); break;
-    case 241: highlighted_instrument = tag; instrument = PIANO;        break;
-    case 242: highlighted_instrument = tag; instrument = ORGAN;        break;
-    case 243: highlighted_instrument = tag; instrument = HARP;         break;
-    case 244: highlighted_instrument = tag; instrument = XYLOPHONE;    break;
-    case 245: highlighted_instrument = tag; instrument = GLOCKENSPIEL; break;
-    case 246: highlighted_instrument = tag; instrument = SINE_WAVE;    break;
-    case 247: highlighted_instrument = tag; instrument = TUBA;         break;
-    case 248: highlighted_instrument = tag; instrument = TRUMPET;      break;
-    case 249: highlighted_instrument = tag; instrument = MUSIC_BOX;    break;
-    case 250: highlighted_instrument = tag; instrument = CHIMES;       break;
-    case 251: highlighted_instrument = tag; instrument = BELL;         break;
-    case 252: highlighted_instrument = tag; instrument = HIHAT;        break;
-    #define GRID_COLS 6
-    case 240: cmd.track_circular (BTN_POS(5,1), BTN_SIZE(2,3), 240); break;
-    default:
-      const uint32_t color = getNoteColor(tag);
-      for(int i = 0; i < NUM_LEDS; i++) {
-        leds[i] = color;
-      }
-      FastLED.show();
-      if(instrument == HIHAT) {
-        switch(tag % 9) {
-          case 0: sound.play(CLICK,    NOTE_C3); break;
-          case 1: sound.play(SWITCH,   NOTE_C3); break;
-          case 2: sound.play(COWBELL,  NOTE_C3); break;
-          case 3: sound.play(NOTCH,    NOTE_C3); break;
-          case 4: sound.play(HIHAT,    NOTE_C3); break;
-          case 5: sound.play(KICKDRUM, NOTE_C3); break;
-          case 6: sound.play(POP,      NOTE_C3); break;
-          case 7: sound.play(CLACK,    NOTE_C3); break;
-          case 8: sound.play(CHACK,    NOTE_C3); break;
-        }
-      } else {
-        sound.play(instrument, NOTE_C3 + tag - 1);
-      }
+  switch(PianoTagMap::lookup(tag)) {
+    case PianoTags::songs: GOTO_SCREEN(SongsScreen); break;
+    #define GRID_ROWS 8
+    #define GRID_COLS 12
+    case PianoTags::volume: cmd.track_circular (BTN_POS(10,1), BTN_SIZE(3,3), volume_tag.first); break;
+    case PianoTags::scroll: cmd.track_linear(0, scrollbar_y, display_width, scrollbar_h, scroll_tag.first); break;
+    case PianoTags::instrument:
+      // Pressing the drum kit again switches to the next kit
+      if(tag == state.highlighted_instrument && pgm_read_byte(&instruments[instrument_tags.index(tag)].drums))
+        DrumKit::select(DrumKit::selected() + 1);
+      state.highlighted_instrument = tag;
+      break;
+    case PianoTags::key:
+      // Light the key's own LED and send a ripple out from it, both for
+      // as long as the key is held. These are drawn later from loop(),
+      // so they do not delay the note.
+      held_led_keys |= uint32_t(1) << (getNote(tag) % LED_KEYS);
+      LedAnimator::key_on(getNote(tag) % LED_KEYS, NoteColors::led(getNote(tag)));
+      key_ripple = LedAnimator::note_on(LedAnimator::key_position(getNote(tag) % LED_KEYS), NoteColors::led(getNote(tag)), LedAnimator::RIPPLE, 0);
+      // Strike the note with a volume that follows how hard the key was
+      // pressed, unless a song or beat is playing, as it would be scaled too
+      if(sound.has_more_notes() || DrumSequencer::is_running())
+        sound.set_volume(state.volume);
+      else
+        sound.set_volume(TouchVelocity::scale(state.volume, get_touch_velocity()));
+      playKey(tag);
       highlighted_note = tag;
+      break;
   }
   onRefresh();
   #undef GRID_ROWS
   #undef GRID_COLS
+  return true;
+}
+
+// Plays a key with the selected instrument. With a drum kit, each
+// key of an octave plays a pad, so every octave plays the same kit.
+void PianoScreen::playKey(uint8_t tag) {
+  const instrument_t *in = &instruments[instrument_tags.index(state.highlighted_instrument)];
+  if(pgm_read_byte(&in->drums)) {
+    DrumKit::play(getNote(tag) % 12);
+  } else {
+    sound.play(effect_t(pgm_read_byte(&in->effect)), getNote(tag));
+  }
+}
+
+bool PianoScreen::onTouchEnd(uint8_t tag) {
+  if(key_tags.contains(tag)) {
+    const uint8_t led_key = getNote(tag) % LED_KEYS;
+    held_led_keys &= ~(uint32_t(1) << led_key);
+    // Leave the LED on if the song is playing that key, until its next note
+    if(led_key != song_led_key) LedAnimator::key_off(led_key);
+    LedAnimator::note_off(key_ripple);
+  }
+  return true;
+}
+
+// Follows along with a song playing in the background, by lighting the key
+// for each note on the LED strip, with a ripple that lasts as long as the
+// note, and, if the keyboard is showing, on screen.
+void PianoScreen::onNoteEvent(effect_t effect, note_t note, uint16_t duration_ms) {
+  // Sound effects, such as the alarm or the clicks of a beat, have no key
+  const bool musical = (effect >= SQUARE_WAVE && effect <= TRIANGLE_WAVE) || (effect >= HARP && effect <= BELL);
+  if(musical || note == REST) {
+    // A key held down on the touch panel stays lit until released
+    if(song_led_key != 0xFF && !(held_led_keys & (uint32_t(1) << song_led_key)))
+      LedAnimator::key_off(song_led_key);
+    song_led_key = 0xFF;
+  }
+  if(!musical || note == REST || note == END_SONG) return;
+
+  // Fold the song into the LED strip the same way as the keys are
+  song_led_key = note % LED_KEYS;
+  LedAnimator::key_on(song_led_key, NoteColors::led(note));
+  LedAnimator::note_on(LedAnimator::key_position(song_led_key), NoteColors::led(note), LedAnimator::RIPPLE, duration_ms);
+  if(AT_SCREEN(PianoScreen) && note >= NOTE_A0 && note <= NOTE_C8) {
+    highlighted_note = key_tags[note - NOTE_A0];
+    onRefresh();
+  }
 }
 
 void PianoScreen::onIdle() {
   uint16_t value;
-  // Once the note finishes playing, unhighlight the key
+  // Once the note finishes playing, unhighlight the key and
+  // go back to the chosen volume, which the key press scaled
   if(!sound.is_sound_playing() && highlighted_note) {
     highlighted_note = 0;
+    sound.set_volume(state.volume);
     onRefresh();
   }
   // Handle the rotation of the dial.
   switch(CLCD::get_tracker(value)) {
-    case 240:
-      volume = max(min(1,(float(value) - dial_min) / (dial_max - dial_min)),0) * 255;
-      sound.set_volume(volume);
-      onRefresh();
+    case volume_tag.first:
+      // Only the dial needs to be redrawn, the new volume goes straight to REG_VOL_SOUND
+      if(volume_map.update(value, state.volume)) {
+        sound.set_volume(state.volume);
+        FrameScheduler::request(FOREGROUND);
+      }
+      break;
+    case scroll_tag.first:
+      if(scroll_map.update(value, state.scroll_x)) onRefresh();
       break;
     default: return;
   }
@@ -284,67 +539,126 @@ void PianoScreen::onIdle() {
 
 /***************************** SONGS SCREEN *****************************/
 
+const char songs_title[] PROGMEM = "Effects and Songs";
+const char start_beat[]  PROGMEM = "Drum Beat";
+const char stop_beat[]   PROGMEM = "Stop Beat";
+const char back_label[]  PROGMEM = "Back";
+
+// The song buttons never change, so they are kept in RAM_G and appended
+// whole; only the beat button, whose label changes, is drawn again.
+enum {
+  static_group,
+  beat_group,
+  num_song_groups
+};
+
+#define GRID_ROWS 5
+#define GRID_COLS 5
+
+const widget_t song_widgets[] PROGMEM = {
+  // type         group         tag                position      size           label
+  {WIDGET_TEXT,   static_group, 0,                 BTN_POS(1,1), BTN_SIZE(5,1), songs_title},
+  {WIDGET_BUTTON, static_group, song_tags[0],      BTN_POS(1,2), BTN_SIZE(1,1), songs[0].label},
+  {WIDGET_BUTTON, static_group, song_tags[1],      BTN_POS(1,3), BTN_SIZE(1,1), songs[1].label},
+  {WIDGET_BUTTON, static_group, song_tags[2],      BTN_POS(1,4), BTN_SIZE(1,1), songs[2].label},
+  {WIDGET_BUTTON, static_group, song_tags[3],      BTN_POS(2,2), BTN_SIZE(1,1), songs[3].label},
+  {WIDGET_BUTTON, static_group, song_tags[4],      BTN_POS(2,3), BTN_SIZE(1,1), songs[4].label},
+  {WIDGET_BUTTON, static_group, song_tags[5],      BTN_POS(2,4), BTN_SIZE(1,1), songs[5].label},
+  {WIDGET_BUTTON, static_group, song_tags[6],      BTN_POS(3,2), BTN_SIZE(1,1), songs[6].label},
+  {WIDGET_BUTTON, static_group, song_tags[7],      BTN_POS(3,3), BTN_SIZE(1,1), songs[7].label},
+  {WIDGET_BUTTON, static_group, song_tags[8],      BTN_POS(3,4), BTN_SIZE(1,1), songs[8].label},
+  {WIDGET_BUTTON, static_group, song_tags[9],      BTN_POS(4,2), BTN_SIZE(1,1), songs[9].label},
+  {WIDGET_BUTTON, static_group, song_tags[10],     BTN_POS(4,3), BTN_SIZE(1,1), songs[10].label},
+  {WIDGET_BUTTON, static_group, song_tags[11],     BTN_POS(4,4), BTN_SIZE(1,1), songs[11].label},
+  {WIDGET_BUTTON, static_group, song_tags[12],     BTN_POS(5,2), BTN_SIZE(1,1), songs[12].label},
+  {WIDGET_BUTTON, static_group, song_tags[13],     BTN_POS(5,3), BTN_SIZE(1,1), songs[13].label},
+  {WIDGET_BUTTON, beat_group,   beat_tag.first,    BTN_POS(5,4), BTN_SIZE(1,1), start_beat},
+  {WIDGET_BUTTON, beat_group,   beat_tag.first,    BTN_POS(5,4), BTN_SIZE(1,1), stop_beat},
+  #undef  MARGIN_T
+  #define MARGIN_T  15
+  {WIDGET_BUTTON, static_group, back_tag.first,    BTN_POS(1,5), BTN_SIZE(5,1), back_label},
+  #undef  MARGIN_T
+  #define MARGIN_T  3
+};
+
+#undef GRID_ROWS
+#undef GRID_COLS
+
+enum {
+  title_widget,
+  first_song_widget,
+  start_beat_widget = first_song_widget + num_songs,
+  stop_beat_widget,
+  back_widget,
+  num_song_widgets
+};
+
+static_assert(sizeof(song_widgets) / sizeof(song_widgets[0]) == num_song_widgets, "A song is missing from song_widgets");
+
+constexpr uint8_t songs_dl_slot = background_dl_slot + 1;
+
+WidgetTree<num_song_widgets, num_song_groups> song_tree(song_widgets, songs_dl_slot);
+
+void SongsScreen::onEntry() {
+  InterfaceScreen::onEntry();
+  fitLabels();
+}
+
+void SongsScreen::fitLabels() {
+  static bool fitted = false;
+  if(fitted) return;
+  fitted = true;
+
+  song_tree.fit_font(title_widget, font_large, font_small);
+  for(uint8_t i = first_song_widget; i < first_song_widget + num_songs; i++)
+    song_tree.fit_font(i, font_medium, font_small - 2);
+  song_tree.fit_font(start_beat_widget, font_medium, font_small - 2);
+  song_tree.fit_font(stop_beat_widget,  font_medium, font_small - 2);
+  song_tree.set_font(back_widget, font_small);
+}
+
 void SongsScreen::onRedraw(draw_mode_t what) {
   CommandProcessor cmd;
   cmd.cmd(CLEAR_COLOR_RGB(0x222222))
-     .cmd(CLEAR(true,true,true));
-     
-  #define GRID_ROWS 5
-  #define GRID_COLS 5
-  
-  cmd.font(font_large)
-     .fgcolor(0x111111)
-     .text(BTN_POS(1,1), BTN_SIZE(5,1), F("Effects and Songs"))
-     .font(font_small)
-     .tag(2).button( BTN_POS(1,2), BTN_SIZE(1,1), F("Chimes"))
-     .tag(3).button( BTN_POS(1,3), BTN_SIZE(1,1), F("Sad Trombone"))
-     .tag(4).button( BTN_POS(1,4), BTN_SIZE(1,1), F("Twinkle"))
-     .tag(5).button( BTN_POS(2,2), BTN_SIZE(1,1), F("Fanfare"))
-     .tag(6).button( BTN_POS(2,3), BTN_SIZE(1,1), F("USB In"))
-     .tag(7).button( BTN_POS(2,4), BTN_SIZE(1,1), F("USB Out"))
-     .tag(8).button( BTN_POS(3,2), BTN_SIZE(1,1), F("Bach Toccata"))
-     .tag(9).button( BTN_POS(3,3), BTN_SIZE(1,1), F("Bach Joy"))
-     .tag(10).button(BTN_POS(3,4), BTN_SIZE(1,1), F("Big Band"))
-     .tag(11).button(BTN_POS(4,2), BTN_SIZE(1,1), F("Beeping"))
-     .tag(12).button(BTN_POS(4,3), BTN_SIZE(1,1), F("Alarm"))
-     .tag(13).button(BTN_POS(4,4), BTN_SIZE(1,1), F("Warble"))
-     .tag(14).button(BTN_POS(5,2), BTN_SIZE(1,1), F("Carousel"))
-     .tag(15).button(BTN_POS(5,3), BTN_SIZE(1,1), F("Beats"))
-  #define MARGIN_T  15
-     .tag(1).button( BTN_POS(1,5), BTN_SIZE(5,1), F("Back"));
-     
-  #undef GRID_ROWS
-  #undef GRID_COLS
+     .cmd(CLEAR(true,true,true))
+     .fgcolor(0x111111);
+
+  song_tree.show(start_beat_widget, !DrumSequencer::is_running());
+  song_tree.show(stop_beat_widget,   DrumSequencer::is_running());
+  song_tree.draw(cmd);
 }
 
-void SongsScreen::onTouchEnd(uint8_t tag) {
-  CommandProcessor cmd;
-  /* See "src/ui_sounds.h" for sound sequences */
-  
-  constexpr play_mode_t mode = PLAY_ASYNCHRONOUS;
-  switch(tag) {
-    case  1: GOTO_SCREEN(PianoScreen);           break;
-    case  2: sound.play(chimes, mode);           break;
-    case  3: sound.play(sad_trombone, mode);     break;
-    case  4: sound.play(twinkle, mode);          break;
-    case  5: sound.play(fanfare, mode);          break;
-    case  6: sound.play(media_inserted, mode);   break;
-    case  7: sound.play(media_removed, mode);    break;
-    case  8: sound.play(js_bach_toccata, mode);  break;
-    case  9: sound.play(js_bach_joy, mode);      break;
-    case 10: sound.play(big_band, mode);         break;
-    case 11: sound.play(beeping, mode);          break;
-    case 12: sound.play(alarm, mode);            break;
-    case 13: sound.play(warble, mode);           break;
-    case 14: sound.play(carousel, mode);         break;
-    case 15: sound.play(beats, mode);            break;
+bool SongsScreen::onTouchEnd(uint8_t tag) {
+  switch(SongTagMap::lookup(tag)) {
+    case SongTags::back:
+      GOTO_PREVIOUS();
+      break;
+    case SongTags::beat:
+      // Loop a beat on the selected drum kit
+      if(DrumSequencer::is_running())
+        DrumSequencer::stop();
+      else
+        DrumSequencer::start(rock_beat, 100);
+      onRefresh();
+      break;
+    case SongTags::song:
+      sound.play((const SoundPlayer::sound_t*) pgm_read_ptr(&songs[song_tags.index(tag)].sequence), PLAY_ASYNCHRONOUS);
+      break;
   }
+  return true;
 }
 
 /***************************** MAIN PROGRAM *****************************/
 
 void setup() {
+  LedAnimator::init();
+  DrumKit::init();
+  SoundPlayer::set_note_observer(PianoScreen::onNoteEvent);
+  // Slide between the piano and songs screens (see ScreenTransition)
+  UIData::enable_animations(true);
   onStartup();
+  // Sending a frame to the LEDs holds off interrupts, so it waits its turn after the redraw
+  TaskScheduler::add(LedAnimator::onIdle, TaskScheduler::PRIORITY_LOW, LED_FRAME_INTERVAL, 1000);
 }
 
 void loop() {
@@ -341,6 +341,19 @@ namespace FTDI {
 
 }
 
+// INTERRUPT FLAGS (REG_INT_FLAGS and REG_INT_MASK)
+
+namespace FTDI {
+  constexpr uint8_t INT_SWAP         = 1 << 0;
+  constexpr uint8_t INT_TOUCH        = 1 << 1;
+  constexpr uint8_t INT_TAG          = 1 << 2;
+  constexpr uint8_t INT_SOUND        = 1 << 3;
+  constexpr uint8_t INT_PLAYBACK     = 1 << 4;
+  constexpr uint8_t INT_CMDEMPTY     = 1 << 5;
+  constexpr uint8_t INT_CMDFLAG      = 1 << 6;
+  constexpr uint8_t INT_CONVCOMPLETE = 1 << 7;
+}
+
 // HOST COMMANDS
 
 namespace FTDI {
@@ -614,6 +627,10 @@ namespace FTDI {
     END_SONG                                        = 0xFF,
     REST                                            = 0x00,
 
+    NOTE_A0                                         = 0x15, // 21
+    NOTE_A0S                                        = 0x16,
+    NOTE_B0                                         = 0x17,
+
     NOTE_C1                                         = 0x18, // 24
     NOTE_C1S                                        = 0x19,
     NOTE_D1                                         = 0x1A,
@@ -678,6 +695,34 @@ namespace FTDI {
     NOTE_A5                                         = 0x51,
     NOTE_A5S                                        = 0x52,
     NOTE_B5                                         = 0x53,
+
+    NOTE_C6                                         = 0x54,  //84
+    NOTE_C6S                                        = 0x55,
+    NOTE_D6                                         = 0x56,
+    NOTE_D6S                                        = 0x57,
+    NOTE_E6                                         = 0x58,
+    NOTE_F6                                         = 0x59,
+    NOTE_F6S                                        = 0x5A,
+    NOTE_G6                                         = 0x5B,
+    NOTE_G6S                                        = 0x5C,
+    NOTE_A6                                         = 0x5D,
+    NOTE_A6S                                        = 0x5E,
+    NOTE_B6                                         = 0x5F,
+
+    NOTE_C7                                         = 0x60,  //96
+    NOTE_C7S                                        = 0x61,
+    NOTE_D7                                         = 0x62,
+    NOTE_D7S                                        = 0x63,
+    NOTE_E7                                         = 0x64,
+    NOTE_F7                                         = 0x65,
+    NOTE_F7S                                        = 0x66,
+    NOTE_G7                                         = 0x67,
+    NOTE_G7S                                        = 0x68,
+    NOTE_A7                                         = 0x69,
+    NOTE_A7S                                        = 0x6A,
+    NOTE_B7                                         = 0x6B,
+
+    NOTE_C8                                         = 0x6C,  //108
   };
 }
 
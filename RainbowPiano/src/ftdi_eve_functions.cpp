@@ -54,6 +54,13 @@ void CLCD::turn_on_backlight (void) {
   mem_write_8(REG_PWM_DUTY, 128);
 }
 
+// Routes the interrupt sources in mask to the INT_N line, a mask of zero disables interrupts
+void CLCD::enable_interrupts (uint8_t mask) {
+  mem_write_8(REG_INT_MASK, mask);
+  mem_write_8(REG_INT_EN,   mask ? 1 : 0);
+  get_interrupt_flags(); // Clear any stale flags
+}
+
 void CLCD::get_font_metrics(uint8_t font, struct FontMetrics &fm) {
   uint32_t rom_fontroot = mem_read_32(ROM_FONT_ADDR);
   mem_read_bulk(rom_fontroot + 148 * (font - 16), (uint8_t*) &fm, 148);
@@ -136,9 +136,19 @@ class CLCD {
 
     static void get_font_metrics (uint8_t font, struct FontMetrics &fm);
 
+    static void    enable_interrupts (uint8_t mask);
+    static uint8_t get_interrupt_flags () {return mem_read_8(FTDI::REG_INT_FLAGS);} // Reading clears the flags
+
     static uint8_t get_tag ()     {return mem_read_8(FTDI::REG_TOUCH_TAG);}
     static bool is_touching ()    {return (mem_read_32(FTDI::REG_TOUCH_DIRECT_XY) & 0x80000000) == 0;}
 
+    // Returns the screen coordinates of the touch, or -32768 for both when not touched
+    static void get_touch_xy (int16_t &x, int16_t &y) {
+      uint32_t xy = mem_read_32(FTDI::REG_TOUCH_SCREEN_XY);
+      x           = xy >> 16;
+      y           = xy & 0xFFFF;
+    }
+
     static uint8_t get_tracker (uint16_t &value) {
       uint32_t tracker = mem_read_32(FTDI::REG_TRACKER);
       value            = tracker >> 16;
@@ -42,6 +42,10 @@ namespace FTDI {
     SET_OUTPUT(CLCD_SPI_CS);
     WRITE(CLCD_SPI_CS, 1);
 
+    #if defined(CLCD_INT_PIN)
+      SET_INPUT_PULLUP(CLCD_INT_PIN); // INT_N is open-drain, active low
+    #endif
+
     #if defined(SPI_FLASH_SS)
       SET_OUTPUT(SPI_FLASH_SS);
       WRITE(SPI_FLASH_SS, 1);
@@ -179,6 +179,55 @@ namespace FTDI {
     0x00, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x00,
     0x00, 0x7F, 0xFF, 0xFF, 0xFF, 0xFC, 0x00
   };
+
+  // A key with rounded bottom corners. It is stretched to the size
+  // of the white and black keys by the bitmap transform.
+
+  constexpr PROGMEM bitmap_info_t Key_Mask_Info = {
+    .format     = L1,
+    .linestride = 2,
+    .filter     = BILINEAR,
+    .wrapx      = BORDER,
+    .wrapy      = BORDER,
+    .RAMG_addr  = RAM_G + 9200,
+    .width      = 16,
+    .height     = 32,
+  };
+
+  constexpr PROGMEM unsigned char Key_Mask[] = {
+    0xFF, 0xFF,                                                  // Piano Key
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0xFF, 0xFF,
+    0x7F, 0xFE,
+    0x3F, 0xFC,
+    0x0F, 0xF0
+  };
 };
 
 #endif // _UI_BITMAPS_
\ No newline at end of file
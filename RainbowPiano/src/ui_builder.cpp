@@ -31,6 +31,15 @@
 #include "ui_builder.h"
 
 CommandProcessor::btn_style_func_t  *CommandProcessor::_btn_style_callback = CommandProcessor::default_button_style_func;
-bool CommandProcessor::is_tracking = false;
+const button_style_t *CommandProcessor::_btn_style_rules = NULL;
+uint8_t  CommandProcessor::_btn_style_count = 0;
+bool     CommandProcessor::is_tracking = false;
+uint32_t CommandProcessor::_fgcolor;
+uint32_t CommandProcessor::_bgcolor;
+uint8_t  CommandProcessor::_style_known = 0;
+
+#if defined(UI_FRAMEWORK_DEBUG)
+  uint16_t CommandProcessor::style_cmds_skipped = 0;
+#endif
 
 #endif // EXTENSIBLE_UI
\ No newline at end of file
@@ -23,6 +23,7 @@
 #define _UI_BUILDER_H_
 
 #include "ui_event_loop.h"
+#include "ui_font_cache.h"
 
 /**************************** GRID LAYOUT MACROS **************************/
 
@@ -104,6 +105,30 @@ namespace FTDI {
 
 /**************************** Enhanced Command Processor **************************/
 
+/* Rather than a style callback, a screen may give the styles of its buttons
+ * as a table of rules in PROGMEM, e.g.:
+ *
+ *   const button_style_t styles[] PROGMEM = {
+ *     // first tag    last tag     rgb       selected rgb  selected tag
+ *     {  1,           12,          0x000000, 0x888888,     &highlighted_tag},
+ *     {  13,          13,          0x000000, 0x000000,     NULL}
+ *   };
+ *
+ *   cmd.set_button_style_rules(styles);
+ *
+ * A button takes the fgcolor of the first rule covering its tag, or the
+ * selected rgb if its tag is the one held in the selected tag variable.
+ * Buttons not covered by any rule keep the current fgcolor. A pressed
+ * button is drawn flat, as with the default callback.
+ */
+
+typedef struct {
+  uint8_t        first_tag, last_tag;
+  uint32_t       rgb;
+  uint32_t       selected_rgb;
+  const uint8_t *selected_tag;  // Or NULL if no button in the range is ever selected
+} button_style_t;
+
 /* The CommandProcessor class wraps the CommandFifo with several features to make
  * defining user interfaces much easier.
  *
@@ -112,6 +137,8 @@ namespace FTDI {
  *   - Constrains all widgets to fit inside a box for ease of layout.
  *   - Font size is specified using a chained modifier.
  *   - Option argument is given the default OPT_3D value.
+ *   - Remembers the last fgcolor and bgcolor sent and skips sending them
+ *     again, until forget_style() is called at the start of each frame.
  */
 
 class CommandProcessor : public CLCD::CommandFifo {
@@ -126,10 +153,32 @@ class CommandProcessor : public CLCD::CommandFifo {
     typedef bool btn_style_func_t(uint8_t tag, uint8_t &style, uint16_t &options, bool post);
 
     static btn_style_func_t  *_btn_style_callback;
+    static const button_style_t *_btn_style_rules;
+    static uint8_t _btn_style_count;
     static bool is_tracking;
     int8_t  _font = 26, _tag = 0;
     uint8_t _style = 0;
 
+    // The coprocessor state last sent, so it need not be sent again
+    static uint32_t _fgcolor, _bgcolor;
+    static uint8_t  _style_known;
+
+    enum {
+      FGCOLOR_KNOWN = 0x01,
+      BGCOLOR_KNOWN = 0x02
+    };
+
+    void apply_style_rules(uint16_t &options) {
+      if(_tag != 0 && get_pressed_tag() == _tag) options = FTDI::OPT_FLAT;
+      for(uint8_t i = 0; i < _btn_style_count; i++) {
+        button_style_t rule;
+        memcpy_P(&rule, &_btn_style_rules[i], sizeof(rule));
+        if(_tag < rule.first_tag || _tag > rule.last_tag) continue;
+        fgcolor(rule.selected_tag && *rule.selected_tag == _tag ? rule.selected_rgb : rule.rgb);
+        break;
+      }
+    }
+
   protected:
     enum {
       STYLE_DISABLED = 0x01
@@ -137,9 +186,7 @@ class CommandProcessor : public CLCD::CommandFifo {
 
     // Returns the cannonical thickness of a widget (i.e. the height of a toggle element)
     uint16_t widget_thickness() {
-      FontMetrics fm;
-      CLCD::get_font_metrics(_font, fm);
-      return fm.height * 20.0/16;
+      return FontCache::height(_font) * 20.0/16;
     }
 
     FORCEDINLINE void linear_widget_box(int16_t &x, int16_t &y, int16_t &w, int16_t &h, bool tracker = false) {
@@ -184,6 +231,26 @@ class CommandProcessor : public CLCD::CommandFifo {
       return *this;
     }
 
+    // Rules take the place of the callback until set to NULL
+    inline CommandProcessor& set_button_style_rules(const button_style_t *rules, uint8_t count) {
+      _btn_style_rules = rules;
+      _btn_style_count = rules ? count : 0;
+      return *this;
+    }
+
+    template<uint8_t N>
+    inline CommandProcessor& set_button_style_rules(const button_style_t (&rules)[N]) {
+      return set_button_style_rules(rules, N);
+    }
+
+    // Must be called whenever the coprocessor may have lost its state,
+    // such as at the start of a display list
+    static void forget_style() {_style_known = 0;}
+
+    #if defined(UI_FRAMEWORK_DEBUG)
+      static uint16_t style_cmds_skipped;
+    #endif
+
     inline CommandProcessor& tag      (uint8_t  tag)              {_tag = tag; cmd(FTDI::TAG(tag)); return *this;}
 
     inline CommandProcessor& font     (int16_t  font)             {_font = font; return *this;}
@@ -197,8 +264,32 @@ class CommandProcessor : public CLCD::CommandFifo {
     inline CommandProcessor& cmd      (void* data, uint16_t len)  {CLCD::CommandFifo::cmd(data, len); return *this;}
     inline CommandProcessor& execute()                            {CLCD::CommandFifo::execute(); return *this;}
 
-    inline CommandProcessor& fgcolor  (uint32_t rgb)              {CLCD::CommandFifo::fgcolor(rgb); return *this;}
-    inline CommandProcessor& bgcolor  (uint32_t rgb)              {CLCD::CommandFifo::bgcolor(rgb); return *this;}
+    CommandProcessor& fgcolor(uint32_t rgb) {
+      if((_style_known & FGCOLOR_KNOWN) && _fgcolor == rgb) {
+        #if defined(UI_FRAMEWORK_DEBUG)
+          style_cmds_skipped++;
+        #endif
+        return *this;
+      }
+      CLCD::CommandFifo::fgcolor(rgb);
+      _fgcolor      = rgb;
+      _style_known |= FGCOLOR_KNOWN;
+      return *this;
+    }
+
+    CommandProcessor& bgcolor(uint32_t rgb) {
+      if((_style_known & BGCOLOR_KNOWN) && _bgcolor == rgb) {
+        #if defined(UI_FRAMEWORK_DEBUG)
+          style_cmds_skipped++;
+        #endif
+        return *this;
+      }
+      CLCD::CommandFifo::bgcolor(rgb);
+      _bgcolor      = rgb;
+      _style_known |= BGCOLOR_KNOWN;
+      return *this;
+    }
+
     inline CommandProcessor& gradcolor(uint32_t rgb)              {CLCD::CommandFifo::gradcolor(rgb); return *this;}
 
     inline CommandProcessor& snapshot (uint32_t ptr)              {CLCD::CommandFifo::snapshot(ptr); return *this;}
@@ -257,15 +348,14 @@ class CommandProcessor : public CLCD::CommandFifo {
 
     template<typename T>
     FORCEDINLINE CommandProcessor& toggle(int16_t x, int16_t y, int16_t w, int16_t h, T text, bool state, uint16_t options = FTDI::OPT_3D) {
-      FontMetrics fm;
-      CLCD::get_font_metrics(_font, fm);
-      const int16_t widget_h = fm.height * 20.0/16;
+      const uint8_t font_h   = FontCache::height(_font);
+      const int16_t widget_h = font_h * 20.0/16;
       //const int16_t outer_bar_r = widget_h / 2;
       //const int16_t knob_r      = outer_bar_r - 1.5;
       // The y coordinate of the toggle is the baseline of the text,
       // so we must introduce a fudge factor based on the line height to
       // actually center the control.
-      const int16_t fudge_y = fm.height*5/16;
+      const int16_t fudge_y = font_h*5/16;
       CLCD::CommandFifo::toggle(x + h/2, y + h/2 - widget_h/2 + fudge_y, w - h, _font, options, state);
       CLCD::CommandFifo::str(text);
       return *this;
@@ -376,6 +466,12 @@ class CommandProcessor : public CLCD::CommandFifo {
     template<typename T>
     CommandProcessor& button(int16_t x, int16_t y, int16_t w, int16_t h, T text, uint16_t options = FTDI::OPT_3D) {
       using namespace FTDI;
+      if(_btn_style_rules) {
+        apply_style_rules(options);
+        CLCD::CommandFifo::button(x, y, w, h, _font, options);
+        CLCD::CommandFifo::str(text);
+        return *this;
+      }
       bool styleModified = false;
       if(_btn_style_callback) styleModified = _btn_style_callback(_tag, _style, options, false);
       CLCD::CommandFifo::button(x, y, w, h, _font, options);
@@ -78,6 +78,58 @@
     //#define USE_FAST_AVR_IO
 #endif
 
+// Touch events are normally found by polling REG_TOUCH_TAG every
+// TOUCH_UPDATE_INTERVAL. If USE_TOUCH_INTERRUPTS is defined, the FT8xx
+// is asked to signal touches on its INT_N line and the touch registers
+// are only read once a touch has been signalled. INT_N must be wired
+// to CLCD_INT_PIN, an Arduino pin capable of external interrupts.
+//#define USE_TOUCH_INTERRUPTS
+#if defined(USE_TOUCH_INTERRUPTS)
+    #define CLCD_INT_PIN                        2
+#endif
+
+// The NeoPixel (WS2812) strip that lights up with the notes being played
+
+#define NUM_LEDS                               16
+#define LED_PIN                                 5
+#define LED_BRIGHTNESS                         64
+#define LED_FRAME_INTERVAL                     20  // Milliseconds between LED animation frames
+#define LED_ANIMATIONS                          4  // Number of effects that may run at once
+#define LED_KEYS                               24  // Number of keys that can light their own LEDs
+
+// Drum kits are kept in EEPROM starting at this address, so they can be
+// edited and survive a power cycle. Each kit takes DRUM_PADS + 1 bytes.
+
+#define DRUM_KITS                               4
+#define DRUM_PADS                              12
+#define DRUM_KIT_EEPROM_ADDR                    0
+
+// Number of fonts whose character widths are kept in RAM for measuring
+// text. Each takes 96 bytes; heights are always kept for every ROM font.
+
+#define FONT_WIDTH_SLOTS                        2
+
+// The screen stack remembers SCREEN_STACK_DEPTH screens to go back to. When
+// full, the oldest screen is forgotten, unless SCREEN_STACK_REFUSE_OVERFLOW
+// is defined, in which case going to another screen fails. Screens which
+// keep their state while away share SCREEN_STATE_ARENA bytes. A change of
+// screen slower than SCREEN_TRANSITION_BUDGET milliseconds is reported when
+// UI_FRAMEWORK_DEBUG is defined.
+
+#define SCREEN_STACK_DEPTH                      4
+//#define SCREEN_STACK_REFUSE_OVERFLOW
+#define SCREEN_STATE_ARENA                     16
+#define SCREEN_TRANSITION_BUDGET               16
+
+// When animations are enabled (see UIData::enable_animations), the
+// outgoing screen slides away over this many milliseconds (FT810 only).
+
+#define SCREEN_TRANSITION_DURATION            250
+
+// Number of tasks the cooperative scheduler can run from the main loop
+
+#define TASK_SLOTS                              6
+
 // Defines how to orient the display. An inverted (i.e. upside-down) display
 // is supported on the FT800. The FT810 or better also support a portrait
 // and mirrored orientation.
@@ -0,0 +1,52 @@
+/******************
+ * ui_constexpr.h *
+ ******************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_CONSTEXPR_H_
+#define _UI_CONSTEXPR_H_
+
+/******************* COMPILE-TIME TABLES ************************/
+
+/* The Arduino compiler only supports C++11, which lacks
+ * std::index_sequence. These templates fill the gap, so
+ * that a PROGMEM table can be generated at compile time
+ * by expanding a constexpr function over every index:
+ *
+ *   template<typename> struct squares;
+ *   template<uint8_t... I> struct squares<index_seq<I...>> {
+ *     static const uint16_t table[sizeof...(I)];
+ *   };
+ *   template<uint8_t... I> const uint16_t squares<index_seq<I...>>::table[] PROGMEM = {(I*I)...};
+ *
+ *   squares<make_index_seq<16>::type>::table  // {0, 1, 4, 9, ... 225}
+ */
+
+namespace UI {
+  template<uint8_t... I> struct index_seq {};
+
+  template<uint8_t N, uint8_t... I> struct make_index_seq : make_index_seq<N - 1, N - 1, I...> {};
+  template<uint8_t... I> struct make_index_seq<0, I...> {typedef index_seq<I...> type;};
+
+  // Stands in for std::is_same, for comparing types at compile time
+  template<class A, class B> struct is_same       {static constexpr bool value = false;};
+  template<class A>          struct is_same<A, A> {static constexpr bool value = true;};
+}
+
+#endif // _UI_CONSTEXPR_H_
@@ -0,0 +1,55 @@
+/**********************
+ * ui_control_map.cpp *
+ **********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include "ui_control_map.h"
+
+uint16_t ControlMap::from_tracker(uint16_t tracker) const {
+  if(tracker <= track_min) return 0;
+  if(tracker >= track_max) return range;
+  return (uint32_t(tracker - track_min) * range + (track_max - track_min) / 2) / (track_max - track_min);
+}
+
+uint16_t ControlMap::to_tracker(uint16_t value) const {
+  return track_min + uint32_t(min(value, range)) * (track_max - track_min) / range;
+}
+
+// Updates value from the tracker, returning true if it changed
+bool ControlMap::update(uint16_t tracker, uint16_t &value) const {
+  const uint16_t new_value = from_tracker(tracker);
+  const uint16_t change    = new_value > value ? new_value - value : value - new_value;
+  if(change == 0) return false;
+  if(change < hysteresis && new_value != 0 && new_value != range) return false;
+  value = new_value;
+  return true;
+}
+
+bool ControlMap::update(uint16_t tracker, uint8_t &value) const {
+  uint16_t v = value;
+  const bool changed = update(tracker, v);
+  value = v;
+  return changed;
+}
+
+#endif // EXTENSIBLE_UI
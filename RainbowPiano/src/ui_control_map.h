@@ -0,0 +1,59 @@
+/********************
+ * ui_control_map.h *
+ ********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_CONTROL_MAP_H_
+#define _UI_CONTROL_MAP_H_
+
+/******************* CONTROL MAPPING ************************/
+
+/* A ControlMap converts between the 16-bit value reported by a tracked
+ * widget (a dial, slider or scrollbar) and a control value from zero to
+ * some range, using integer math only. Changes smaller than the
+ * hysteresis are ignored, so that a finger resting on a widget does not
+ * cause the value to dither and the screen to be redrawn; the two ends
+ * of the range can always be reached.
+ *
+ *   ControlMap volume_map(4095, 61440, 255, 2);
+ *
+ *   if(volume_map.update(tracker_value, volume)) ...  // volume changed
+ *
+ *   cmd.dial(..., volume_map.to_tracker(volume));
+ */
+
+class ControlMap {
+  private:
+    const uint16_t track_min;
+    const uint16_t track_max;
+    const uint16_t range;
+    const uint8_t  hysteresis;
+
+  public:
+    constexpr ControlMap(uint16_t track_min, uint16_t track_max, uint16_t range, uint8_t hysteresis = 1) :
+      track_min(track_min), track_max(track_max), range(range), hysteresis(hysteresis) {}
+
+    uint16_t from_tracker(uint16_t tracker) const;
+    uint16_t to_tracker(uint16_t value) const;
+
+    bool update(uint16_t tracker, uint16_t &value) const;
+    bool update(uint16_t tracker, uint8_t  &value) const;
+};
+
+#endif // _UI_CONTROL_MAP_H_
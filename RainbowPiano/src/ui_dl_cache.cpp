@@ -96,6 +96,22 @@ bool DLCache::wait_until_idle() {
   return true;
 }
 
+/* This marks the start of the portion of the display
+ * list that will be cached by store(), so that only
+ * what is added afterwards is saved.
+ */
+
+void DLCache::begin_segment() {
+  CLCD::CommandFifo cmd;
+
+  // Execute any commands already in the FIFO
+  cmd.execute();
+  if(!wait_until_idle())
+    return;
+
+  dl_start = CLCD::mem_read_32(REG_CMD_DL) & 0x1FFF;
+}
+
 /* This caches the current display list in RAMG so
  * that it can be appended later. The memory is
  * dynamically allocated following DL_FREE_ADDR.
@@ -114,7 +130,7 @@ bool DLCache::store(uint32_t num_bytes /* = 0*/) {
     return false;
 
   // Figure out how long the display list is
-  uint32_t new_dl_size = CLCD::mem_read_32(REG_CMD_DL) & 0x1FFF;
+  uint32_t new_dl_size = (CLCD::mem_read_32(REG_CMD_DL) & 0x1FFF) - dl_start;
   uint32_t free_space  = 0;
   uint32_t dl_alloc    = 0;
 
@@ -146,7 +162,7 @@ bool DLCache::store(uint32_t num_bytes /* = 0*/) {
       SERIAL_ECHOPAIR("Saving DL to RAMG cache, bytes: ", dl_size);
       SERIAL_ECHOLNPAIR(" Free space: ", free_space);
     #endif
-    cmd.memcpy(dl_addr, RAM_DL, dl_size);
+    cmd.memcpy(dl_addr, RAM_DL + dl_start, dl_size);
     cmd.execute();
     save_slot(dl_slot, dl_addr, dl_size);
     if(dl_alloc > 0) {
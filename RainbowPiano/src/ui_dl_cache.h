@@ -41,12 +41,17 @@
  *        // Add stuff to the DL
  *        dlcache.store();
  *     }
+ *
+ * By default the whole display list is stored. Calling begin_segment()
+ * before adding stuff to the DL stores only what follows, so that part
+ * of a screen can be cached and later appended wherever it is needed.
  */
 class DLCache {
   private:
     uint8_t  dl_slot;
     uint32_t dl_addr;
     uint16_t dl_size;
+    uint16_t dl_start;
 
     void load_slot();
     static void save_slot(uint8_t dl_slot, uint32_t dl_addr, uint32_t dl_size);
@@ -57,11 +62,13 @@ class DLCache {
     static void init();
 
     DLCache(uint8_t slot) {
-      dl_slot = slot;
+      dl_slot  = slot;
+      dl_start = 0;
       load_slot();
     }
 
     bool has_data();
+    void begin_segment();
     bool store(uint32_t num_bytes = 0);
     void append();
 };
@@ -0,0 +1,178 @@
+/*******************
+ * ui_drum_kit.cpp *
+ *******************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include <EEPROM.h>
+
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
+
+#include "ui_sounds.h"
+#include "ui_drum_kit.h"
+
+// Marks the EEPROM as holding drum kits of the current size
+#define DRUM_KIT_MAGIC  (0xD0 ^ DRUM_KITS ^ (DRUM_PADS << 3))
+
+#define PAD(sound, semitones) (((sound - CLICK) << 4) | (semitones))
+#define NO_PAD                 0xF0
+
+namespace FTDI {
+  const uint8_t default_kits[DRUM_KITS][DRUM_PADS + 1] PROGMEM = {
+    { // Standard kit: kick, snares and hi-hats
+      NOTE_C3,
+      PAD(KICKDRUM, 0), PAD(CLICK,  0), PAD(CLACK,   0), PAD(SWITCH,   0),
+      PAD(CHACK,    0), PAD(POP,    0), PAD(HIHAT,   0), PAD(POP,      4),
+      PAD(HIHAT,    4), PAD(COWBELL,0), PAD(HIHAT,   8), PAD(COWBELL,  5)
+    },
+    { // Every percussion sound in turn
+      NOTE_C3,
+      PAD(CLICK,    0), PAD(SWITCH, 0), PAD(COWBELL, 0), PAD(NOTCH,    0),
+      PAD(HIHAT,    0), PAD(KICKDRUM,0),PAD(POP,     0), PAD(CLACK,    0),
+      PAD(CHACK,    0), PAD(CLICK,  7), PAD(SWITCH,  7), PAD(COWBELL,  7)
+    },
+    { // Tuned toms
+      NOTE_C2,
+      PAD(POP,      0), PAD(POP,    1), PAD(POP,     2), PAD(POP,      3),
+      PAD(POP,      4), PAD(POP,    5), PAD(POP,     6), PAD(POP,      7),
+      PAD(POP,      8), PAD(POP,    9), PAD(POP,    10), PAD(POP,     11)
+    },
+    { // Cowbells
+      NOTE_C4,
+      PAD(COWBELL,  0), PAD(COWBELL,1), PAD(COWBELL, 2), PAD(COWBELL,  3),
+      PAD(COWBELL,  4), PAD(COWBELL,5), PAD(COWBELL, 6), PAD(COWBELL,  7),
+      PAD(COWBELL,  8), PAD(COWBELL,9), PAD(COWBELL,10), PAD(COWBELL, 11)
+    }
+  };
+
+  // Steps of the patterns below, on the standard kit
+  constexpr uint8_t kick  = 0;
+  constexpr uint8_t snare = 2;
+  constexpr uint8_t hihat = 6;
+  constexpr uint8_t rest  = DrumSequencer::REST_STEP;
+  constexpr uint8_t end   = DrumSequencer::END_STEP;
+
+  const uint8_t rock_beat[] PROGMEM = {
+    kick, rest, hihat, rest, snare, rest, hihat, rest, kick, kick, hihat, rest, snare, rest, hihat, rest, end
+  };
+
+  const uint8_t shuffle_beat[] PROGMEM = {
+    kick, rest, rest, hihat, rest, rest, snare, rest, rest, hihat, rest, rest, kick, rest, hihat, rest, end
+  };
+
+  /******************* DRUM KITS ************************/
+
+  uint8_t DrumKit::kit;
+  uint8_t DrumKit::base_note;
+  uint8_t DrumKit::pads[DRUM_PADS];
+
+  // Loads the first kit, filling the EEPROM with the default kits if it does not hold any
+  void DrumKit::init() {
+    if(EEPROM.read(DRUM_KIT_EEPROM_ADDR) != DRUM_KIT_MAGIC) reset();
+    select(0);
+  }
+
+  // Restores all kits to their defaults
+  void DrumKit::reset() {
+    for(uint8_t k = 0; k < DRUM_KITS; k++) {
+      for(uint8_t i = 0; i < DRUM_PADS + 1; i++) {
+        EEPROM.update(kit_addr(k) + i, pgm_read_byte(&default_kits[k][i]));
+      }
+    }
+    EEPROM.update(DRUM_KIT_EEPROM_ADDR, DRUM_KIT_MAGIC);
+    select(kit);
+  }
+
+  void DrumKit::select(uint8_t k) {
+    kit       = k % DRUM_KITS;
+    base_note = EEPROM.read(kit_addr(kit));
+    for(uint8_t i = 0; i < DRUM_PADS; i++) {
+      pads[i] = EEPROM.read(kit_addr(kit) + 1 + i);
+    }
+  }
+
+  effect_t DrumKit::get_effect(uint8_t pad) {
+    const uint8_t sound = pads[pad % DRUM_PADS] >> 4;
+    return sound == NO_SOUND ? SILENCE : effect_t(CLICK + sound);
+  }
+
+  note_t DrumKit::get_note(uint8_t pad) {
+    return note_t(base_note + (pads[pad % DRUM_PADS] & 0x0F));
+  }
+
+  // Changes a pad of the selected kit, saving it to EEPROM
+  void DrumKit::set_pad(uint8_t pad, effect_t effect, uint8_t semitones) {
+    pad %= DRUM_PADS;
+    pads[pad] = (effect >= CLICK && effect <= CHACK) ? PAD(effect, semitones & 0x0F) : NO_PAD;
+    EEPROM.update(kit_addr(kit) + 1 + pad, pads[pad]);
+  }
+
+  void DrumKit::play(uint8_t pad) {
+    const effect_t effect = get_effect(pad);
+    if(effect != SILENCE) SoundPlayer::play(effect, get_note(pad));
+  }
+
+  /******************* DRUM SEQUENCER ************************/
+
+  const uint8_t *DrumSequencer::pattern = 0;
+  uint8_t        DrumSequencer::step;
+  uint16_t       DrumSequencer::step_ms;
+
+  static short_timer_t step_timer;
+
+  void DrumSequencer::start(const uint8_t *p, uint16_t beats_per_minute) {
+    pattern = p;
+    step    = 0;
+    step_ms = 60000 / 4 / max(1, beats_per_minute);
+    step_timer.start();
+    SoundPlayer::set_generator(onIdle);
+    // Play the first step right away
+    const uint8_t pad = pgm_read_byte(&pattern[0]);
+    if(pad < DRUM_PADS) DrumKit::play(pad);
+  }
+
+  void DrumSequencer::stop() {
+    pattern = 0;
+    SoundPlayer::set_generator(NULL);
+  }
+
+  void DrumSequencer::onIdle() {
+    if(!pattern || !step_timer.elapsed(step_ms)) return;
+    // Advance from the previous deadline, so the tempo does not drift. If
+    // steps were missed while a sound was playing, start over from now
+    // rather than playing all the missed steps at once.
+    if(step_timer.elapsed(2 * step_ms))
+      step_timer.start();
+    else
+      step_timer.advance(step_ms);
+
+    uint8_t pad = pgm_read_byte(&pattern[++step]);
+    if(pad == END_STEP) {
+      step = 0;
+      pad  = pgm_read_byte(&pattern[0]);
+    }
+    if(pad < DRUM_PADS) DrumKit::play(pad);
+  }
+} // namespace FTDI
+
+#endif // EXTENSIBLE_UI
@@ -0,0 +1,91 @@
+/*****************
+ * ui_drum_kit.h *
+ *****************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_DRUM_KIT_H_
+#define _UI_DRUM_KIT_H_
+
+/******************* DRUM KITS ************************/
+
+/* A drum kit assigns one of the FT810's percussion sounds, and a
+ * pitch to play it at, to each of DRUM_PADS pads. The kits live in
+ * EEPROM, one byte per pad plus a base note for the kit:
+ *
+ *   bits 7-4: the sound, counting from CLICK (0xF for no sound)
+ *   bits 3-0: semitones above the kit's base note
+ *
+ * The EEPROM is filled with the default kits the first time it is
+ * used. Only the selected kit is kept in RAM.
+ */
+
+namespace FTDI {
+  class DrumKit {
+    public:
+      static constexpr uint8_t NO_SOUND = 0xF;
+
+    private:
+      static uint8_t kit;
+      static uint8_t base_note;
+      static uint8_t pads[DRUM_PADS];
+
+      static uint16_t kit_addr(uint8_t kit) {return DRUM_KIT_EEPROM_ADDR + 1 + kit * (DRUM_PADS + 1);}
+
+    public:
+      static void     init();
+      static void     reset();
+
+      static void     select(uint8_t kit);
+      static uint8_t  selected() {return kit;}
+
+      static effect_t get_effect(uint8_t pad);
+      static note_t   get_note(uint8_t pad);
+      static void     set_pad(uint8_t pad, effect_t effect, uint8_t semitones);
+
+      static void     play(uint8_t pad);
+  };
+
+  /* The DrumSequencer plays a pattern on the selected drum kit, one pad
+   * (or REST_STEP) per step, looping until stopped. It runs from
+   * SoundPlayer::onIdle() whenever no sound sequence is playing.
+   */
+  class DrumSequencer {
+    public:
+      static constexpr uint8_t REST_STEP = 0xFE;
+      static constexpr uint8_t END_STEP  = 0xFF;
+
+    private:
+      static const uint8_t *pattern;
+      static uint8_t        step;
+      static uint16_t       step_ms;
+
+    public:
+      static void start(const uint8_t *pattern, uint16_t beats_per_minute);
+      static void stop();
+      static bool is_running() {return pattern != 0;}
+
+      static void onIdle();
+  };
+
+  // Built-in patterns: sixteen steps to the bar, in PROGMEM
+  extern const uint8_t rock_beat[];
+  extern const uint8_t shuffle_beat[];
+}
+
+#endif // _UI_DRUM_KIT_H_
@@ -32,8 +32,11 @@
 #include "ui_theme.h"
 #include "ui_builder.h"
 #include "ui_dl_cache.h"
+#include "ui_frame_scheduler.h"
+#include "ui_task_scheduler.h"
 #include "ui_event_loop.h"
 #include "ui_sounds.h"
+#include "ui_velocity.h"
 
 using namespace FTDI;
 
@@ -41,9 +44,18 @@ enum {
   UNPRESSED       = 0x00
 };
 
-tiny_timer_t touch_timer;
+short_timer_t touch_timer;
+short_timer_t slide_timer;
 UIData::flags_t UIData::flags;
 uint8_t pressed_tag  = UNPRESSED;
+uint8_t touch_velocity = 0;
+
+PROGMEM const input_profile_t input_profiles[] = {
+  // MENU_INPUT_PROFILE
+  {TOUCH_UPDATE_INTERVAL, DEBOUNCE_PERIOD, 1000 / TOUCH_REPEATS_PER_SECOND, 0},
+  // MUSICAL_INPUT_PROFILE
+  {2,                     20,              250,                            30}
+};
 
 uint8_t UIData::get_value() {
   return flags.value;
@@ -72,35 +84,134 @@ bool UIData::animations_enabled() {
   return UIData::flags.bits.show_animations;
 }
 
+/******************* TOUCH INTERRUPTS ***********************/
+
+#if defined(USE_TOUCH_INTERRUPTS)
+  #if !defined(CLCD_INT_PIN)
+    #error "USE_TOUCH_INTERRUPTS requires the INT_N line to be wired to CLCD_INT_PIN"
+  #endif
+
+  constexpr uint8_t touch_interrupts = INT_TOUCH | INT_TAG;
+
+  // Start with an interrupt pending so the first pass of
+  // the event loop always reads the touch registers.
+  static volatile bool touch_interrupt = true;
+
+  static void on_touch_interrupt() {
+    touch_interrupt = true;
+  }
+
+  static bool touch_interrupt_pending() {
+    return touch_interrupt;
+  }
+
+  static void acknowledge_touch_interrupt() {
+    touch_interrupt = false;
+    // Reading REG_INT_FLAGS clears them and releases INT_N,
+    // so that the next touch generates a new falling edge.
+    CLCD::get_interrupt_flags();
+  }
+#endif
+
 uint8_t get_pressed_tag() {
   return pressed_tag;
 }
 
+uint8_t get_touch_velocity() {
+  return touch_velocity;
+}
+
 bool is_touch_held() {
   return pressed_tag != 0;
 }
 
 namespace UI {
+  // Sliding is only for tags which the screen lets a touch slide across,
+  // such as the keys of a keyboard. Moving onto any other tag is ignored
+  // until the touch is released, as for a menu.
+  static bool canSlide(uint8_t tag, const input_profile_t &profile) {
+    return profile.slide_interval && !UIData::flags.bits.ignore_unpress &&
+           current_screen.isSlideTag(pressed_tag) && current_screen.isSlideTag(tag);
+  }
+
+  // Called when a held touch moves directly from one tag to another. Rather
+  // than waiting for a release and debounce, the old tag is released and the
+  // new one pressed right away, so sliding across keys plays each in turn.
+  static void onSlide(uint8_t tag, const input_profile_t &profile) {
+    if(!slide_timer.elapsed(profile.slide_interval)) return;
+    slide_timer.start();
+
+    #if defined(UI_FRAMEWORK_DEBUG)
+      SERIAL_ECHO_START();
+      SERIAL_ECHOLNPAIR("Touch slide: ", tag);
+    #endif
+
+    UIData::flags.bits.touch_debouncing = false;
+
+    const uint8_t saved_pressed_tag = pressed_tag;
+    pressed_tag = tag;
+    current_screen.onTouchEnd(saved_pressed_tag);
+
+    // Each key of a glissando is struck as hard as the finger presses on it
+    touch_velocity = TouchVelocity::sample();
+
+    const uint8_t lastScreen = current_screen.getScreen();
+    if(current_screen.onTouchStart(tag)) {
+      touch_timer.start();
+    }
+    UIData::flags.bits.ignore_unpress = lastScreen != current_screen.getScreen();
+    current_screen.onRefresh();
+  }
+
+  static void onTouchIdle();
+  static void onSoundIdle()  {sound.onIdle();}
+  static void onScreenIdle() {current_screen.onIdle();}
+
   void onStartup() {
     using namespace UI;
 
     CLCD::init();
     DLCache::init();
 
+    // Starting the next note of a song is checked between all the other
+    // tasks, so it is never held up by more than one of them.
+    TaskScheduler::add(onSoundIdle,            TaskScheduler::PRIORITY_URGENT, 0, SOUND_TASK_BUDGET);
+    TaskScheduler::add(onTouchIdle,            TaskScheduler::PRIORITY_NORMAL, 0, TOUCH_TASK_BUDGET);
+    TaskScheduler::add(onScreenIdle,           TaskScheduler::PRIORITY_NORMAL, 0, SCREEN_TASK_BUDGET);
+    TaskScheduler::add(FrameScheduler::onIdle, TaskScheduler::PRIORITY_LOW,    0, REDRAW_TASK_BUDGET);
+
+    #if defined(USE_TOUCH_INTERRUPTS)
+      CLCD::enable_interrupts(touch_interrupts);
+      attachInterrupt(digitalPinToInterrupt(CLCD_INT_PIN), on_touch_interrupt, FALLING);
+    #endif
+
     current_screen.start();
   }
 
-  void onIdle() {
-    sound.onIdle();
-    current_screen.onIdle();
+  static void onTouchIdle() {
+    input_profile_t profile;
+    memcpy_P(&profile, &input_profiles[current_screen.getInputProfile()], sizeof(profile));
+
+    #if defined(USE_TOUCH_INTERRUPTS)
+      // While nothing is pressed, the touch registers are left
+      // alone until the FT8xx signals a touch, at which point
+      // they are read right away.
+      const bool poll_touch = is_touch_held() ? touch_timer.elapsed(profile.touch_update_interval) : touch_interrupt_pending();
+    #else
+      const bool poll_touch = touch_timer.elapsed(profile.touch_update_interval);
+    #endif
 
     // If the LCD is processing commands, don't check
     // for tags since they may be changing and could
     // cause spurious events.
-    if(!touch_timer.elapsed(TOUCH_UPDATE_INTERVAL) || CLCD::CommandFifo::is_processing()) {
+    if(!poll_touch || CLCD::CommandFifo::is_processing()) {
       return;
     }
 
+    #if defined(USE_TOUCH_INTERRUPTS)
+      acknowledge_touch_interrupt();
+    #endif
+
     const uint8_t tag = CLCD::get_tag();
 
     switch(pressed_tag) {
@@ -112,6 +223,7 @@ namespace UI {
           #endif
 
           pressed_tag = tag;
+          touch_velocity = TouchVelocity::sample();
           current_screen.onRefresh();
 
           // When the user taps on a button, activate the onTouchStart handler
@@ -138,7 +250,7 @@ namespace UI {
         if(!UIData::flags.bits.touch_debouncing) {
           if(tag == pressed_tag) {
             // The user is holding down a button.
-            if(touch_timer.elapsed(1000 / TOUCH_REPEATS_PER_SECOND) && current_screen.onTouchHeld(tag)) {
+            if(touch_timer.elapsed(profile.touch_repeat_interval) && current_screen.onTouchHeld(tag)) {
               current_screen.onRefresh();
               if(UIData::flags.bits.touch_repeat_sound) sound.play(Theme::repeat_sound);
               touch_timer.start();
@@ -148,6 +260,10 @@ namespace UI {
             touch_timer.start();
             UIData::flags.bits.touch_debouncing = true;
           }
+          else if(canSlide(tag, profile)) {
+            // The user slid onto a different button.
+            onSlide(tag, profile);
+          }
         }
 
         else {
@@ -158,7 +274,12 @@ namespace UI {
             UIData::flags.bits.touch_debouncing = false;
           }
 
-          else if(touch_timer.elapsed(DEBOUNCE_PERIOD)) {
+          else if(tag != 0 && canSlide(tag, profile)) {
+            // The user slid onto a different button, briefly losing contact.
+            onSlide(tag, profile);
+          }
+
+          else if(touch_timer.elapsed(profile.debounce_period)) {
             UIData::flags.bits.touch_debouncing = false;
 
             if(UIData::flags.bits.ignore_unpress) {
@@ -183,7 +304,11 @@ namespace UI {
         break;
     } // switch(pressed_tag)
 
-  } // onIdle()
+  } // onTouchIdle()
+
+  void onIdle() {
+    TaskScheduler::onIdle();
+  }
 
 } // UI
 
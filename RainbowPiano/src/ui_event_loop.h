@@ -28,6 +28,33 @@
 #define TOUCH_REPEATS_PER_SECOND      4
 #define DEBOUNCE_PERIOD             150
 
+// Budgets, in microseconds, for each of the tasks run by the event loop
+#define SOUND_TASK_BUDGET           200
+#define TOUCH_TASK_BUDGET          2000
+#define SCREEN_TASK_BUDGET         2000
+#define REDRAW_TASK_BUDGET        12000
+
+/* An input profile determines how quickly the touch panel is polled
+ * and debounced, and whether sliding a held touch from one button onto
+ * another presses the new button (as for a glissando on a keyboard).
+ * Sliding is further limited to the tags for which the screen's static
+ * isSlideTag() is true. The defaults above suit menus, but are much too
+ * slow for playing music. Each screen selects a profile with its static
+ * inputProfile member and the event loop switches profiles whenever the
+ * current screen changes. All times are in milliseconds.
+ */
+typedef struct {
+  uint16_t touch_update_interval;
+  uint16_t debounce_period;
+  uint16_t touch_repeat_interval;
+  uint16_t slide_interval;        // Minimum time between slides, or zero to disable sliding
+} input_profile_t;
+
+enum {
+  MENU_INPUT_PROFILE,
+  MUSICAL_INPUT_PROFILE
+};
+
 class UIData {
   private:
     typedef union {
@@ -59,6 +86,7 @@ class UIData {
 };
 
 uint8_t get_pressed_tag();
+uint8_t get_touch_velocity();
 bool    is_touch_held();
 
 #endif // _UI_EVENT_LOOP_
\ No newline at end of file
@@ -0,0 +1,122 @@
+/*********************
+ * ui_font_cache.cpp *
+ *********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
+
+#include "ui_font_cache.h"
+
+using namespace FTDI;
+
+// Each ROM font is described by a 148 byte record: 128 character widths,
+// followed by the format, stride, width and height as 32-bit values.
+#define FONT_RECORD_SIZE   148
+#define FONT_HEIGHT_OFFSET 140
+
+uint8_t FontCache::heights[num_fonts];
+uint8_t FontCache::slot_font[FONT_WIDTH_SLOTS];
+uint8_t FontCache::slot_widths[FONT_WIDTH_SLOTS][num_chars];
+uint8_t FontCache::next_slot = 0;
+
+uint32_t FontCache::font_addr(uint8_t font) {
+  static uint32_t rom_fontroot = 0;
+  if(!rom_fontroot) rom_fontroot = CLCD::mem_read_32(ROM_FONT_ADDR);
+  return rom_fontroot + FONT_RECORD_SIZE * (font - first_font);
+}
+
+uint8_t FontCache::height(uint8_t font) {
+  if(!is_rom_font(font)) {
+    FontMetrics fm;
+    CLCD::get_font_metrics(font, fm);
+    return fm.height;
+  }
+  uint8_t &h = heights[font - first_font];
+  if(!h) h = CLCD::mem_read_8(font_addr(font) + FONT_HEIGHT_OFFSET);
+  return h;
+}
+
+// Returns the widths of the printable characters, replacing the least recently loaded font if needed
+const uint8_t *FontCache::widths(uint8_t font) {
+  for(uint8_t i = 0; i < FONT_WIDTH_SLOTS; i++) {
+    if(slot_font[i] == font) return slot_widths[i];
+  }
+  const uint8_t i = next_slot;
+  next_slot = (next_slot + 1) % FONT_WIDTH_SLOTS;
+  CLCD::mem_read_bulk(font_addr(font) + first_char, slot_widths[i], num_chars);
+  slot_font[i] = font;
+  #if defined(UI_FRAMEWORK_DEBUG)
+    SERIAL_ECHO_START();
+    SERIAL_ECHOLNPAIR("Loaded character widths for font ", font);
+  #endif
+  return slot_widths[i];
+}
+
+uint8_t FontCache::char_width(uint8_t font, char c) {
+  if(c < first_char || c >= first_char + num_chars) return 0;
+  if(!is_rom_font(font)) {
+    FontMetrics fm;
+    CLCD::get_font_metrics(font, fm);
+    return fm.char_widths[uint8_t(c)];
+  }
+  return widths(font)[c - first_char];
+}
+
+uint16_t FontCache::text_width(uint8_t font, const char *str) {
+  if(!is_rom_font(font)) return 0;
+  const uint8_t *w = widths(font);
+  uint16_t width = 0;
+  for(char c; (c = *str); str++) {
+    if(c >= first_char && c < first_char + num_chars) width += w[c - first_char];
+  }
+  return width;
+}
+
+uint16_t FontCache::text_width(uint8_t font, progmem_str str) {
+  if(!is_rom_font(font)) return 0;
+  const uint8_t *w = widths(font);
+  const char *p = (const char *) str;
+  uint16_t width = 0;
+  for(char c; (c = pgm_read_byte(p)); p++) {
+    if(c >= first_char && c < first_char + num_chars) width += w[c - first_char];
+  }
+  return width;
+}
+
+// Returns the largest font, between largest and smallest, in which a label fits a w by h box
+uint8_t FontCache::fit_font(progmem_str label, uint16_t w, uint16_t h, uint8_t largest, uint8_t smallest) {
+  const uint16_t max_w = w > 2 * label_padding ? w - 2 * label_padding : 0;
+  uint8_t font = largest;
+  for(; font > smallest; font--) {
+    if(height(font) <= h && text_width(font, label) <= max_w) break;
+  }
+  #if defined(UI_FRAMEWORK_DEBUG)
+    SERIAL_ECHO_START();
+    SERIAL_ECHOPAIR("Label \"", label);
+    SERIAL_ECHOLNPAIR("\" fits font ", font);
+  #endif
+  return font;
+}
+
+#endif // EXTENSIBLE_UI
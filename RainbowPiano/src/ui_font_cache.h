@@ -0,0 +1,72 @@
+/*******************
+ * ui_font_cache.h *
+ *******************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_FONT_CACHE_H_
+#define _UI_FONT_CACHE_H_
+
+/******************* FONT METRICS CACHE ************************/
+
+/* CLCD::get_font_metrics() reads 148 bytes from the FT810 every time
+ * it is called, which adds up when it is done for each widget on
+ * every redraw. The FontCache instead keeps the height of each of
+ * the sixteen ROM fonts, read the first time it is needed, and the
+ * character widths for the few fonts most recently measured, so
+ * that laying out a screen takes no reads from the FT810 at all.
+ *
+ * Only the printable characters (32 to 127) are kept; other
+ * characters are measured as zero width. Fonts outside of the
+ * ROM fonts are not cached and are read on every call.
+ *
+ * fit_font() uses the cached widths to pick the largest font in which
+ * a label fits inside a button. Trying each font reads its widths, so
+ * the choice is meant to be made once, when a screen is entered, and
+ * kept by the screen for its redraws.
+ */
+
+class FontCache {
+  private:
+    static constexpr uint8_t first_font  = 16;
+    static constexpr uint8_t num_fonts   = 16;
+    static constexpr uint8_t first_char  = 32;
+    static constexpr uint8_t num_chars   = 96;
+
+    static uint8_t heights[num_fonts];
+    static uint8_t slot_font[FONT_WIDTH_SLOTS];
+    static uint8_t slot_widths[FONT_WIDTH_SLOTS][num_chars];
+    static uint8_t next_slot;
+
+    static uint32_t font_addr(uint8_t font);
+    static bool     is_rom_font(uint8_t font) {return font >= first_font && font < first_font + num_fonts;}
+    static const uint8_t *widths(uint8_t font);
+
+  public:
+    static uint8_t  height(uint8_t font);
+    static uint8_t  char_width(uint8_t font, char c);
+    static uint16_t text_width(uint8_t font, const char *str);
+    static uint16_t text_width(uint8_t font, progmem_str str);
+
+    // Padding, in pixels, kept between a label and the sides of its button
+    static constexpr uint8_t label_padding = 6;
+
+    static uint8_t fit_font(progmem_str label, uint16_t w, uint16_t h, uint8_t largest = 31, uint8_t smallest = 26);
+};
+
+#endif // _UI_FONT_CACHE_H_
@@ -0,0 +1,89 @@
+/**************************
+ * ui_frame_scheduler.cpp *
+ **************************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
+#include "ftdi_eve_panels.h"
+
+#include "ui_framework.h"
+#include "ui_builder.h"
+#include "ui_frame_scheduler.h"
+#include "ui_transition.h"
+
+using namespace FTDI;
+
+uint8_t  FrameScheduler::pending    = 0;
+uint32_t FrameScheduler::last_frame = 0;
+uint16_t FrameScheduler::swaps      = 0;
+uint16_t FrameScheduler::coalesced  = 0;
+uint16_t FrameScheduler::deferred   = 0;
+
+void FrameScheduler::request(draw_mode_t what) {
+  if(pending) coalesced++;
+  pending |= what;
+}
+
+void FrameScheduler::paint(draw_mode_t what) {
+  CLCD::CommandFifo cmd;
+  cmd.cmd(CMD_DLSTART);
+  CommandProcessor::forget_style();
+
+  if(!ScreenTransition::paint(cmd))
+    current_screen.onRedraw(what);
+
+  cmd.cmd(DL::DL_DISPLAY);
+  cmd.cmd(CMD_SWAP);
+  cmd.execute();
+}
+
+void FrameScheduler::onIdle() {
+  if(!pending) return;
+
+  // Wait for the previous display list to be swapped in and
+  // for the panel to start on a new frame before drawing again.
+  const uint32_t frame = CLCD::mem_read_32(REG_FRAMES);
+  if(frame == last_frame || CLCD::CommandFifo::is_processing()) {
+    deferred++;
+    return;
+  }
+
+  const draw_mode_t what = draw_mode_t(pending);
+  pending    = 0;
+  last_frame = frame;
+  paint(what);
+  swaps++;
+
+  #if defined(UI_FRAMEWORK_DEBUG)
+    if(swaps % 256 == 0) {
+      SERIAL_ECHO_START();
+      SERIAL_ECHOPAIR("Frames swapped: ", swaps);
+      SERIAL_ECHOPAIR(" coalesced: ", coalesced);
+      SERIAL_ECHOPAIR(" deferred: ", deferred);
+      SERIAL_ECHOLNPAIR(" style commands skipped: ", CommandProcessor::style_cmds_skipped);
+    }
+  #endif
+}
+
+#endif // EXTENSIBLE_UI
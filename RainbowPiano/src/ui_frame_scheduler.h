@@ -0,0 +1,59 @@
+/************************
+ * ui_frame_scheduler.h *
+ ************************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_FRAME_SCHEDULER_H_
+#define _UI_FRAME_SCHEDULER_H_
+
+#include "ui_framework.h"
+
+/******************* FRAME SCHEDULER ************************/
+
+/* Rather than building and swapping a new display list every
+ * time a screen asks to be refreshed, screens request a redraw
+ * from the FrameScheduler. Requests are merged until the event
+ * loop gets around to drawing, and no more than one display list
+ * is swapped in per frame scanned out by the panel (as counted
+ * by REG_FRAMES), since any more would never be seen.
+ *
+ * The counters report how many swaps were made, how many
+ * requests were merged into an already pending redraw and how
+ * many times a pending redraw had to wait for the panel.
+ */
+class FrameScheduler {
+  private:
+    static uint8_t  pending;
+    static uint32_t last_frame;
+
+  public:
+    static uint16_t swaps;
+    static uint16_t coalesced;
+    static uint16_t deferred;
+
+    static void request(draw_mode_t what = BOTH);
+    static bool is_pending() {return pending != 0;}
+
+    static void paint(draw_mode_t what = BOTH);
+    static void reset_stats() {swaps = coalesced = deferred = 0;}
+
+    static void onIdle();
+};
+
+#endif // _UI_FRAME_SCHEDULER_H_
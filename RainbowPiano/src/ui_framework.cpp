@@ -20,77 +20,115 @@
  ****************************************************************************/
 
 #include "ui.h"
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
 #include "ui_framework.h"
+#include "ui_transition.h"
 
 /********************** VIRTUAL DISPATCH DATA TYPE  ******************************/
 
-uint8_t ScreenRef::lookupScreen(onRedraw_func_t onRedraw_ptr) {
-  for(uint8_t type = 0; type < functionTableSize; type++) {
-    if(GET_METHOD(type, onRedraw) == onRedraw_ptr) {
-      return type;
-    }
-  }
-  #if defined(UI_FRAMEWORK_DEBUG)
-    SERIAL_ECHO_START();
-    SERIAL_ECHOPAIR("Screen not found: ", (uintptr_t) onRedraw_ptr);
-  #endif
-  return 0xFF;
+// The dispatch methods of ScreenRef are defined by SCREEN_TABLE in the sketch
+
+/********************** SCREEN STACK  ******************************/
+
+void ScreenStack::start() {
+  depth          = 0;
+  arena_used     = 0;
+  state_restored = false;
+  initializeAll();
+  onEntry();
 }
 
-void ScreenRef::setScreen(onRedraw_func_t onRedraw_ptr) {
-  uint8_t type = lookupScreen(onRedraw_ptr);
-  if(type != 0xFF) {
-    setType(type);
+// Copies the state of the current screen to the top of the arena
+void ScreenStack::saveState() {
+  uint8_t size = getStateSize();
+  if(size > sizeof(arena) - arena_used) {
     #if defined(UI_FRAMEWORK_DEBUG)
       SERIAL_ECHO_START();
-      SERIAL_ECHOLNPAIR("New screen: ", type);
+      SERIAL_ECHOLNPAIR("No room to keep state of screen ", getType());
     #endif
+    size = 0;
   }
+  memcpy(arena + arena_used, getStateData(), size);
+  arena_used += size;
+  state_size[depth] = size;
 }
 
-void ScreenRef::initializeAll() {
-  for(uint8_t type = 0; type < functionTableSize; type++) {
-    GET_METHOD(type, onStartup)();
-  }
+// Copies the state of the current screen back from the top of the arena
+void ScreenStack::restoreState() {
+  const uint8_t size = state_size[depth];
+  arena_used -= size;
+  memcpy(getStateData(), arena + arena_used, size);
+  state_restored = size;
 }
 
-/********************** SCREEN STACK  ******************************/
-
-void ScreenStack::start() {
-  initializeAll();
-  onEntry();
+// Drops the bottom of the stack, along with any state kept for it
+void ScreenStack::forgetOldest() {
+  const uint8_t size = state_size[0];
+  memmove(arena, arena + size, arena_used - size);
+  arena_used -= size;
+  memmove(stack,      stack + 1,      depth - 1);
+  memmove(state_size, state_size + 1, depth - 1);
+  depth--;
 }
 
 void ScreenStack::push() {
-  stack[3] = stack[2];
-  stack[2] = stack[1];
-  stack[1] = stack[0];
-  stack[0] = getType();
+  if(depth == SCREEN_STACK_DEPTH) forgetOldest();
+  saveState();
+  stack[depth++] = getType();
 }
 
 void ScreenStack::pop() {
-  setType(stack[0]);
-  forget();
+  if(depth) {
+    setType(stack[--depth]);
+    restoreState();
+  } else {
+    // With nothing to go back to, return to the first screen
+    setType(0);
+  }
 }
 
-void ScreenStack::forget() {
-  stack[0] = stack[1];
-  stack[1] = stack[2];
-  stack[2] = stack[3];
-  stack[3] = 0;
+void ScreenStack::reportTiming(uint32_t start_us) {
+  const uint32_t elapsed = micros() - start_us;
+  transition_us = min(elapsed, uint32_t(0xFFFF));
+  #if defined(UI_FRAMEWORK_DEBUG)
+    if(elapsed > SCREEN_TRANSITION_BUDGET * 1000UL) {
+      SERIAL_ECHO_START();
+      SERIAL_ECHOPAIR("Screen change over budget, us: ", elapsed);
+      SERIAL_ECHOLNPAIR(" screen: ", getType());
+    }
+  #endif
 }
 
-void ScreenStack::goTo(onRedraw_func_t s) {
-  push();
+bool ScreenStack::goTo(uint8_t screen) {
+  if(depth == SCREEN_STACK_DEPTH) {
+    #if defined(UI_FRAMEWORK_DEBUG)
+      SERIAL_ECHO_START();
+      SERIAL_ECHOLNPGM("Screen stack full");
+    #endif
+    #if defined(SCREEN_STACK_REFUSE_OVERFLOW)
+      return false;
+    #endif
+  }
+  const uint32_t start_us = micros();
+  if(UIData::animations_enabled()) ScreenTransition::start(ScreenTransition::SLIDE_LEFT);
   onExit();
-  setScreen(s);
+  push();
+  setType(screen);
+  state_restored = false;
   onEntry();
+  reportTiming(start_us);
+  return true;
 }
 
 void ScreenStack::goBack() {
+  const uint32_t start_us = micros();
+  if(UIData::animations_enabled()) ScreenTransition::start(ScreenTransition::SLIDE_RIGHT);
   onExit();
   pop();
   onEntry();
+  state_restored = false;
+  reportTiming(start_us);
 }
 
 ScreenStack current_screen;
\ No newline at end of file
@@ -23,6 +23,8 @@
 #define _UI_FRAMEWORK_H_
 
 #include "ui.h"
+#include "ui_event_loop.h"
+#include "ui_constexpr.h"
 
 typedef enum {
   BACKGROUND  = 1,
@@ -35,98 +37,171 @@ typedef enum {
 // True virtual classes are extremely expensive on the Arduino
 // as the compiler stores the virtual function tables in RAM.
 // We invent a data type called ScreenRef that gives us
-// polymorphism by mapping an ID to virtual methods on various
-// classes. This works by keeping a table in PROGMEM of pointers
-// to static methods.
-
-#define DECL_SCREEN(className) { \
-  className::onStartup, \
-  className::onEntry, \
-  className::onExit, \
-  className::onIdle, \
-  className::onRefresh, \
-  className::onRedraw, \
-  className::onTouchStart, \
-  className::onTouchHeld, \
-  className::onTouchEnd \
+// polymorphism by mapping an ID to static methods on various
+// classes.
+//
+// The screens are listed once, in the sketch, with:
+//
+//   SCREEN_TABLE(MainScreen, MenuScreen, ...)
+//
+// The ID of a screen is its position in that list, which is known
+// at compile time, so GOTO_SCREEN and AT_SCREEN reduce to constants.
+// SCREEN_TABLE also defines the ScreenRef methods, which compare the
+// ID against each screen in turn and call its static method directly.
+// Since the do-nothing handlers in UIScreen are inline, the compiler
+// drops them and only the screens which implement a handler are
+// tested for.
+
+template<class... S> struct ScreenList;
+
+template<> struct ScreenList<> {
+  static constexpr uint8_t size = 0;
+
+  template<class T> static constexpr uint8_t id() {return 0;}
+
+  static void    onStartup()                      {}
+  static void    onEntry(uint8_t)                 {}
+  static void    onExit(uint8_t)                  {}
+  static void    onIdle(uint8_t)                  {}
+  static void    onRefresh(uint8_t)               {}
+  static void    onRedraw(uint8_t, draw_mode_t)   {}
+  static bool    onTouchStart(uint8_t, uint8_t)   {return false;}
+  static bool    onTouchHeld(uint8_t, uint8_t)    {return false;}
+  static bool    onTouchEnd(uint8_t, uint8_t)     {return false;}
+  static bool    isSlideTag(uint8_t, uint8_t)     {return false;}
+  static uint8_t inputProfile(uint8_t)            {return 0;}
+  static uint8_t stateSize(uint8_t)               {return 0;}
+  static void   *stateData(uint8_t)               {return NULL;}
+};
+
+template<class F, class... R> struct ScreenList<F, R...> {
+  typedef ScreenList<R...> rest;
+
+  static constexpr uint8_t size = 1 + sizeof...(R);
+
+  // Position of screen T in the list, or size if it is not listed
+  template<class T> static constexpr uint8_t id() {
+    return UI::is_same<T, F>::value ? 0 : 1 + rest::template id<T>();
+  }
+
+  static void    onStartup()                                {F::onStartup(); rest::onStartup();}
+  static void    onEntry(uint8_t type)                      {if(type == 0) F::onEntry();   else rest::onEntry(type - 1);}
+  static void    onExit(uint8_t type)                       {if(type == 0) F::onExit();    else rest::onExit(type - 1);}
+  static void    onIdle(uint8_t type)                       {if(type == 0) F::onIdle();    else rest::onIdle(type - 1);}
+  static void    onRefresh(uint8_t type)                    {if(type == 0) F::onRefresh(); else rest::onRefresh(type - 1);}
+  static void    onRedraw(uint8_t type, draw_mode_t dm)     {if(type == 0) F::onRedraw(dm); else rest::onRedraw(type - 1, dm);}
+  static bool    onTouchStart(uint8_t type, uint8_t tag)    {return type == 0 ? F::onTouchStart(tag) : rest::onTouchStart(type - 1, tag);}
+  static bool    onTouchHeld(uint8_t type, uint8_t tag)     {return type == 0 ? F::onTouchHeld(tag)  : rest::onTouchHeld(type - 1, tag);}
+  static bool    onTouchEnd(uint8_t type, uint8_t tag)      {return type == 0 ? F::onTouchEnd(tag)   : rest::onTouchEnd(type - 1, tag);}
+  static bool    isSlideTag(uint8_t type, uint8_t tag)      {return type == 0 ? F::isSlideTag(tag)   : rest::isSlideTag(type - 1, tag);}
+  static uint8_t inputProfile(uint8_t type)                 {return type == 0 ? F::inputProfile      : rest::inputProfile(type - 1);}
+  static uint8_t stateSize(uint8_t type)                    {return type == 0 ? F::stateSize         : rest::stateSize(type - 1);}
+  static void   *stateData(uint8_t type)                    {return type == 0 ? F::stateData()       : rest::stateData(type - 1);}
+};
+
+#define SCREEN_TABLE(...) \
+  typedef ScreenList<__VA_ARGS__> screen_list_t; \
+  void    ScreenRef::initializeAll()            {screen_list_t::onStartup();} \
+  void    ScreenRef::onEntry()                  {screen_list_t::onEntry(type);} \
+  void    ScreenRef::onExit()                   {screen_list_t::onExit(type);} \
+  void    ScreenRef::onIdle()                   {screen_list_t::onIdle(type);} \
+  void    ScreenRef::onRefresh()                {screen_list_t::onRefresh(type);} \
+  void    ScreenRef::onRedraw(draw_mode_t dm)   {screen_list_t::onRedraw(type, dm);} \
+  bool    ScreenRef::onTouchStart(uint8_t tag)  {return screen_list_t::onTouchStart(type, tag);} \
+  bool    ScreenRef::onTouchHeld(uint8_t tag)   {return screen_list_t::onTouchHeld(type, tag);} \
+  bool    ScreenRef::onTouchEnd(uint8_t tag)    {return screen_list_t::onTouchEnd(type, tag);} \
+  bool    ScreenRef::isSlideTag(uint8_t tag)    {return screen_list_t::isSlideTag(type, tag);} \
+  uint8_t ScreenRef::getInputProfile()          {return screen_list_t::inputProfile(type);} \
+  uint8_t ScreenRef::getStateSize()             {return screen_list_t::stateSize(type);} \
+  void   *ScreenRef::getStateData()             {return screen_list_t::stateData(type);}
+
+// Returns the ID of a screen, failing to compile if it is not in SCREEN_TABLE
+template<class L, class S> constexpr uint8_t screen_id() {
+  static_assert(L::template id<S>() < L::size, "Screen is not listed in SCREEN_TABLE");
+  return L::template id<S>();
 }
 
-#define GET_METHOD(type, method) reinterpret_cast<method##_func_t*>(pgm_read_ptr_far(&functionTable[type].method##_ptr))
-#define SCREEN_TABLE             PROGMEM const ScreenRef::table_t ScreenRef::functionTable[] =
-#define SCREEN_TABLE_POST        const uint8_t ScreenRef::functionTableSize = sizeof(ScreenRef::functionTable)/sizeof(ScreenRef::functionTable[0]);
+#define SCREEN_ID(screen)     screen_id<screen_list_t, screen>()
 
 class ScreenRef {
   protected:
-    typedef void onStartup_func_t(void);
-    typedef void onEntry_func_t(void);
-    typedef void onExit_func_t(void);
-    typedef void onIdle_func_t(void);
-    typedef void onRefresh_func_t(void);
-    typedef void onRedraw_func_t(draw_mode_t);
-    typedef bool onTouchStart_func_t(uint8_t);
-    typedef bool onTouchHeld_func_t(uint8_t);
-    typedef bool onTouchEnd_func_t(uint8_t);
-
-  private:
-    typedef struct {
-      onStartup_func_t     *onStartup_ptr;
-      onEntry_func_t       *onEntry_ptr;
-      onExit_func_t        *onExit_ptr;
-      onIdle_func_t        *onIdle_ptr;
-      onRefresh_func_t     *onRefresh_ptr;
-      onRedraw_func_t      *onRedraw_ptr;
-      onTouchStart_func_t  *onTouchStart_ptr;
-      onTouchHeld_func_t   *onTouchHeld_ptr;
-      onTouchEnd_func_t    *onTouchEnd_ptr;
-    } table_t;
-
     uint8_t type = 0;
-    static PROGMEM const table_t functionTable[];
-    static const uint8_t functionTableSize;
 
   public:
     uint8_t getType() {return type;}
 
     void setType(uint8_t t) {
       type = t;
+      #if defined(UI_FRAMEWORK_DEBUG)
+        SERIAL_ECHO_START();
+        SERIAL_ECHOLNPAIR("New screen: ", t);
+      #endif
     }
 
-    uint8_t lookupScreen(onRedraw_func_t onRedraw_ptr);
-
-    void setScreen(onRedraw_func_t onRedraw_ptr);
-
-    void onStartup()               {GET_METHOD(type, onStartup)();}
-    void onEntry()                 {GET_METHOD(type, onEntry)();}
-    void onExit()                  {GET_METHOD(type, onExit)();}
-    void onIdle()                  {GET_METHOD(type, onIdle)();}
-    void onRefresh()               {GET_METHOD(type, onRefresh)();}
-    void onRedraw(draw_mode_t dm)  {GET_METHOD(type, onRedraw)(dm);}
-    bool onTouchStart(uint8_t tag) {return GET_METHOD(type, onTouchStart)(tag);}
-    bool onTouchHeld(uint8_t tag)  {return GET_METHOD(type, onTouchHeld)(tag);}
-    bool onTouchEnd(uint8_t tag)   {return GET_METHOD(type, onTouchEnd)(tag);}
+    // These are defined by SCREEN_TABLE
+    void onEntry();
+    void onExit();
+    void onIdle();
+    void onRefresh();
+    void onRedraw(draw_mode_t dm);
+    bool onTouchStart(uint8_t tag);
+    bool onTouchHeld(uint8_t tag);
+    bool onTouchEnd(uint8_t tag);
+    bool isSlideTag(uint8_t tag);
+
+    uint8_t getInputProfile();
+    uint8_t getStateSize();
+    void   *getStateData();
 
     void initializeAll();
 };
 
 /********************** SCREEN STACK  ******************************/
 
-// To conserve dynamic memory, the screen stack is hard-coded to
-// have four values, allowing a menu of up to four levels.
+/* The screen stack remembers up to SCREEN_STACK_DEPTH screens to go
+ * back to. When it is full, goTo() either forgets the oldest screen
+ * or, if SCREEN_STACK_REFUSE_OVERFLOW is defined, refuses to leave
+ * the current screen and returns false.
+ *
+ * A screen may keep its state across a visit to another screen by
+ * declaring stateSize and stateData() (see UIScreen). The state is
+ * copied into a small arena as the screen is left and copied back
+ * before onEntry() when it is returned to, at which point restored()
+ * is true, so the screen can skip setting itself up again. If the
+ * arena is full, the state is not kept and the screen starts afresh.
+ *
+ * The time taken by onExit() and onEntry() is measured on each change
+ * of screen and, with UI_FRAMEWORK_DEBUG, reported when it exceeds
+ * SCREEN_TRANSITION_BUDGET.
+ */
 
 class ScreenStack : public ScreenRef {
   private:
-    uint8_t stack[4];
+    uint8_t  stack[SCREEN_STACK_DEPTH];
+    uint8_t  state_size[SCREEN_STACK_DEPTH];
+    uint8_t  depth;
+    uint8_t  arena[SCREEN_STATE_ARENA];
+    uint8_t  arena_used;
+    bool     state_restored;
+    uint16_t transition_us;
+
+    void saveState();
+    void restoreState();
+    void forgetOldest();
+    void reportTiming(uint32_t start_us);
 
   public:
     void start();
     void push();
     void pop();
-    void forget();
-    void goTo(onRedraw_func_t s);
+    bool goTo(uint8_t screen);
     void goBack();
 
-    uint8_t peek()      {return stack[0];}
-    uint8_t getScreen() {return getType();}
+    uint8_t  peek()           {return depth ? stack[depth - 1] : 0xFF;}
+    uint8_t  getScreen()      {return getType();}
+    uint8_t  getDepth()       {return depth;}
+    bool     restored()       {return state_restored;}
+    uint16_t transitionTime() {return transition_us;} // Microseconds taken by the last change of screen
 };
 
 extern ScreenStack current_screen;
@@ -137,6 +212,13 @@ extern ScreenStack current_screen;
  */
 class UIScreen {
   public:
+    static constexpr uint8_t inputProfile = MENU_INPUT_PROFILE;
+
+    // A screen which keeps its state on the screen stack sets stateSize
+    // and returns its state from stateData(). See ScreenStack.
+    static constexpr uint8_t stateSize = 0;
+    static void *stateData()           {return NULL;}
+
     static void onStartup()            {}
     static void onEntry()              {current_screen.onRefresh();}
     static void onExit()               {}
@@ -144,11 +226,15 @@ class UIScreen {
     static bool onTouchStart(uint8_t)  {return true;}
     static bool onTouchHeld(uint8_t)   {return false;}
     static bool onTouchEnd(uint8_t)    {return true;}
+
+    // With a profile that allows sliding, a held touch only slides
+    // from one tag to another when this is true for both of them.
+    static bool isSlideTag(uint8_t)    {return false;}
 };
 
-#define GOTO_SCREEN(screen)   current_screen.goTo(screen::onRedraw);
+#define GOTO_SCREEN(screen)   current_screen.goTo(SCREEN_ID(screen));
 #define GOTO_PREVIOUS()       current_screen.goBack();
-#define AT_SCREEN(screen)     (current_screen.getType() == current_screen.lookupScreen(screen::onRedraw))
-#define IS_PARENT_SCREEN(screen) (current_screen.peek() == current_screen.lookupScreen(screen::onRedraw))
+#define AT_SCREEN(screen)     (current_screen.getType() == SCREEN_ID(screen))
+#define IS_PARENT_SCREEN(screen) (current_screen.peek() == SCREEN_ID(screen))
 
 #endif // _UI_FRAMEWORK_H_
@@ -0,0 +1,191 @@
+/*****************
+ * ui_keyboard.h *
+ *****************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_KEYBOARD_H_
+#define _UI_KEYBOARD_H_
+
+#include "ui_constexpr.h"
+
+/**************************** KEYBOARD LAYOUT **************************/
+
+/* KeyboardLayout draws a piano keyboard from a table of key positions
+ * which is computed entirely at compile time and kept in PROGMEM, so
+ * drawing a keyboard of any size costs one table read per key.
+ *
+ * The keyboard is described by a class of constants, for example:
+ *
+ *   struct TwoOctaves {
+ *     static constexpr uint8_t first_note   = FTDI::NOTE_C3;
+ *     static constexpr uint8_t num_keys     = 24;
+ *     static constexpr int16_t x = 0, y = 200, w = 800, h = 280;
+ *     static constexpr uint8_t black_width  = 100; // Percent of a white key's width
+ *     static constexpr uint8_t black_height = 60;  // Percent of a white key's height
+ *     static constexpr uint8_t margin       = 3;   // Pixels around each key
+ *   };
+ *
+ *   KeyboardLayout<TwoOctaves>::draw(cmd);
+ *
+ * The white keys are listed before the black keys, so the black keys
+ * get drawn on top. Each key is given the tag of its position on the
+ * keyboard, counting from first_tag for the lowest note.
+ *
+ * draw() makes each key a CMD_BUTTON, which the coprocessor expands
+ * into several display list entries. draw_bitmaps() instead stamps a
+ * key shaped bitmap, loaded into RAM_G once by KeyboardBitmaps::load(),
+ * so each key costs only a TAG and a VERTEX2F. Since buttons are not
+ * used, the key to highlight and its color must be given to it.
+ */
+
+struct KeyboardBitmaps {
+  static constexpr uint8_t handle = 1;
+
+  static void load() {
+    CLCD::mem_write_pgm(FTDI::Key_Mask_Info.RAMG_addr, FTDI::Key_Mask, sizeof(FTDI::Key_Mask));
+  }
+
+  // Stretches the key mask to the size of a key
+  static void key_size(CommandProcessor &cmd, uint16_t w, uint16_t h) {
+    using namespace FTDI;
+    cmd.cmd(BITMAP_TRANSFORM_A(uint32_t(256) * Key_Mask_Info.width  / w))
+       .cmd(BITMAP_TRANSFORM_E(uint32_t(256) * Key_Mask_Info.height / h))
+       .bitmap_size(Key_Mask_Info.filter, Key_Mask_Info.wrapx, Key_Mask_Info.wrapy, w, h);
+  }
+};
+
+struct keyboard_key_t {
+  int16_t  x;
+  uint16_t w;
+  uint16_t h;
+  uint8_t  note;
+};
+
+template<class L, typename> struct keyboard_table;
+
+template<class L>
+class KeyboardLayout {
+  public:
+    static constexpr bool is_black(uint8_t note) {
+      return (note % 12 == 1) || (note % 12 == 3) || (note % 12 == 6) || (note % 12 == 8) || (note % 12 == 10);
+    }
+
+    // Number of white keys below a note, counting from the lowest C
+    static constexpr uint16_t whites_below(uint8_t note) {
+      return note / 12 * 7 + (note % 12 + 1 + (note % 12 > 4)) / 2;
+    }
+
+    static constexpr uint8_t  last_note  = L::first_note + L::num_keys;
+    static constexpr uint16_t num_whites = whites_below(last_note) - whites_below(L::first_note);
+
+    // Left edge of the nth white key
+    static constexpr int16_t white_x(uint16_t n) {
+      return L::x + int32_t(n) * L::w / num_whites;
+    }
+
+    static constexpr uint16_t black_w() {
+      return uint32_t(white_x(1) - white_x(0)) * L::black_width / 100;
+    }
+
+    static constexpr keyboard_key_t make_key(uint8_t note) {
+      return is_black(note) ?
+        keyboard_key_t {
+          int16_t(white_x(whites_below(note) - whites_below(L::first_note)) - black_w()/2 + L::margin),
+          uint16_t(black_w() - 2 * L::margin),
+          uint16_t(uint32_t(L::h) * L::black_height / 100 - 2 * L::margin),
+          note
+        } :
+        keyboard_key_t {
+          int16_t(white_x(whites_below(note) - whites_below(L::first_note)) + L::margin),
+          uint16_t(white_x(whites_below(note) - whites_below(L::first_note) + 1) -
+                   white_x(whites_below(note) - whites_below(L::first_note)) - 2 * L::margin),
+          uint16_t(L::h - 2 * L::margin),
+          note
+        };
+    }
+
+    // Returns the nth white or black key at or above a note
+    static constexpr uint8_t nth_key(uint8_t note, uint8_t n, bool black) {
+      return is_black(note) != black ? nth_key(note + 1, n, black) :
+             n == 0                  ? note :
+                                       nth_key(note + 1, n - 1, black);
+    }
+
+    // Returns the note drawn in position i, with the white keys first
+    static constexpr uint8_t draw_order(uint8_t i) {
+      return i < num_whites ? nth_key(L::first_note, i, false) : nth_key(L::first_note, i - num_whites, true);
+    }
+
+    typedef keyboard_table<L, typename UI::make_index_seq<L::num_keys>::type> table;
+
+    static constexpr uint8_t num_keys = L::num_keys;
+
+    static FTDI::note_t note(uint8_t key) {return FTDI::note_t(L::first_note + key);}
+    static bool is_black_key(uint8_t key) {return is_black(L::first_note + key);}
+
+    static void draw(CommandProcessor &cmd, uint8_t first_tag = 1, uint8_t highlight_tag = 0, uint32_t highlight_rgb = 0,
+                     uint32_t white_rgb = 0xFFFFFF, uint32_t black_rgb = 0x000000) {
+      for(uint8_t i = 0; i < num_keys; i++) {
+        keyboard_key_t k;
+        memcpy_P(&k, &table::keys[i], sizeof(k));
+        const uint8_t tag = first_tag + k.note - L::first_note;
+        cmd.fgcolor(tag == highlight_tag ? highlight_rgb : i < num_whites ? white_rgb : black_rgb)
+           .tag(tag)
+           .button(k.x, L::y + L::margin, k.w, k.h, F(""), FTDI::OPT_FLAT);
+      }
+    }
+
+    static void draw_bitmaps(CommandProcessor &cmd, uint8_t first_tag = 1, uint8_t highlight_tag = 0, uint32_t highlight_rgb = 0,
+                             uint32_t white_rgb = 0xFFFFFF, uint32_t black_rgb = 0x000000) {
+      using namespace FTDI;
+      cmd.cmd(SAVE_CONTEXT())
+         .cmd(BITMAP_HANDLE(KeyboardBitmaps::handle))
+         .cmd(BITMAP_SOURCE(Key_Mask_Info))
+         .cmd(BITMAP_LAYOUT(Key_Mask_Info))
+         .cmd(BEGIN(BITMAPS));
+      uint32_t rgb = white_rgb;
+      for(uint8_t i = 0; i < num_keys; i++) {
+        keyboard_key_t k;
+        memcpy_P(&k, &table::keys[i], sizeof(k));
+        if(i == 0 || i == num_whites) {
+          rgb = i ? black_rgb : white_rgb;
+          KeyboardBitmaps::key_size(cmd, k.w, k.h);
+          cmd.cmd(COLOR_RGB(rgb));
+        }
+        const uint8_t tag = first_tag + k.note - L::first_note;
+        if(tag == highlight_tag) cmd.cmd(COLOR_RGB(highlight_rgb));
+        cmd.cmd(TAG(tag))
+           .cmd(VERTEX2F(k.x * 16, (L::y + L::margin) * 16));
+        if(tag == highlight_tag) cmd.cmd(COLOR_RGB(rgb));
+      }
+      cmd.cmd(RESTORE_CONTEXT());
+    }
+};
+
+template<class L, uint8_t... I>
+struct keyboard_table<L, UI::index_seq<I...>> {
+  static const keyboard_key_t keys[sizeof...(I)];
+};
+
+template<class L, uint8_t... I>
+const keyboard_key_t keyboard_table<L, UI::index_seq<I...>>::keys[sizeof...(I)] PROGMEM = {
+  KeyboardLayout<L>::make_key(KeyboardLayout<L>::draw_order(I))...
+};
+
+#endif // _UI_KEYBOARD_H_
@@ -0,0 +1,168 @@
+/***********************
+ * ui_led_animator.cpp *
+ ***********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
+
+#include "ui_led_animator.h"
+
+// A ripple is a band of light two LEDs wide, moving
+// outwards by a third of a LED every frame.
+#define RIPPLE_WIDTH   32
+#define RIPPLE_SPEED    5
+
+// A released key fades out over about a third of a second
+#define KEY_RELEASE_DECAY  (255 * LED_FRAME_INTERVAL / 300)
+
+static_assert(LED_KEYS <= 32, "The held keys must fit in a 32-bit mask.");
+
+CRGB                     LedAnimator::leds[NUM_LEDS];
+LedAnimator::animation_t LedAnimator::animations[LED_ANIMATIONS];
+uint8_t                  LedAnimator::next_animation = 0;
+uint8_t                  LedAnimator::next_id        = 0;
+
+CRGB                     LedAnimator::key_colors[LED_KEYS];
+uint8_t                  LedAnimator::key_levels[LED_KEYS];
+uint32_t                 LedAnimator::held_keys = 0;
+const uint8_t           *LedAnimator::key_map   = LedAnimator::linear_map<UI::make_index_seq<LED_KEYS>::type>::table;
+
+void LedAnimator::init() {
+  FastLED.addLeds<NEOPIXEL, LED_PIN>(leds, NUM_LEDS);
+  FastLED.setBrightness(LED_BRIGHTNESS);
+  clear();
+}
+
+void LedAnimator::clear() {
+  for(uint8_t i = 0; i < LED_ANIMATIONS; i++) {
+    animations[i].effect = NONE;
+  }
+  for(uint8_t i = 0; i < LED_KEYS; i++) {
+    key_levels[i] = 0;
+  }
+  held_keys = 0;
+}
+
+/**
+ * Replaces the key to LED map. The map must be in PROGMEM and
+ * hold the index of a LED for each of the LED_KEYS keys.
+ */
+void LedAnimator::set_key_map(const uint8_t *map) {
+  key_map = map;
+}
+
+void LedAnimator::key_on(uint8_t key, CRGB color) {
+  if(key >= LED_KEYS) return;
+  key_colors[key] = color;
+  key_levels[key] = 255;
+  held_keys |= uint32_t(1) << key;
+}
+
+void LedAnimator::key_off(uint8_t key) {
+  if(key >= LED_KEYS) return;
+  held_keys &= ~(uint32_t(1) << key);
+}
+
+// Starts an effect, returning an id for note_off()
+uint8_t LedAnimator::note_on(uint16_t position, CRGB color, led_effect_t effect, uint16_t duration_ms) {
+  // Take over the oldest animation
+  animation_t &a = animations[next_animation];
+  next_animation = (next_animation + 1) % LED_ANIMATIONS;
+
+  a.color  = color;
+  a.origin = position;
+  a.radius = 0;
+  a.level  = 255;
+  a.effect = effect;
+  a.id     = next_id++;
+  // Fade out over the length of the note, or hold until note_off()
+  a.decay  = duration_ms ? max(1, min(255, uint32_t(255) * LED_FRAME_INTERVAL / duration_ms)) : 0;
+  return a.id;
+}
+
+// Lets a held effect fade out like a released key. Does nothing if
+// the effect has already ended or made way for a newer one.
+void LedAnimator::note_off(uint8_t id) {
+  for(uint8_t i = 0; i < LED_ANIMATIONS; i++) {
+    animation_t &a = animations[i];
+    if(a.effect != NONE && a.id == id && !a.decay) a.decay = KEY_RELEASE_DECAY;
+  }
+}
+
+// Returns the brightness an animation gives to a position along the strip
+uint8_t LedAnimator::intensity(const animation_t &a, uint16_t position) {
+  switch(a.effect) {
+    case RIPPLE: {
+      const uint16_t distance = position > a.origin ? position - a.origin : a.origin - position;
+      const uint16_t offset   = distance > a.radius ? distance - a.radius : a.radius - distance;
+      if(offset >= RIPPLE_WIDTH) return 0;
+      return scale8(a.level, 255 - offset * (256 / RIPPLE_WIDTH));
+    }
+    default:
+      return 0;
+  }
+}
+
+void LedAnimator::onIdle() {
+  CRGB frame[NUM_LEDS];
+  for(uint8_t i = 0; i < NUM_LEDS; i++) {
+    const uint16_t position = i * 16 + 8; // Center of the LED
+    CRGB c = CRGB::Black;
+    for(uint8_t j = 0; j < LED_ANIMATIONS; j++) {
+      const uint8_t level = intensity(animations[j], position);
+      if(level) c += CRGB(animations[j].color).nscale8(level);
+    }
+    frame[i] = c;
+  }
+
+  // Light the LEDs of the keys that are held or fading
+  for(uint8_t k = 0; k < LED_KEYS; k++) {
+    if(!key_levels[k]) continue;
+    const uint8_t i = pgm_read_byte(&key_map[k]);
+    if(i < NUM_LEDS) frame[i] += CRGB(key_colors[k]).nscale8(key_levels[k]);
+    if(!(held_keys & (uint32_t(1) << k))) key_levels[k] = qsub8(key_levels[k], KEY_RELEASE_DECAY);
+  }
+
+  bool changed = false;
+  for(uint8_t i = 0; i < NUM_LEDS; i++) {
+    if(leds[i] != frame[i]) {
+      leds[i] = frame[i];
+      changed = true;
+    }
+  }
+
+  // Advance the animations to the next frame
+  for(uint8_t j = 0; j < LED_ANIMATIONS; j++) {
+    animation_t &a = animations[j];
+    if(a.effect == NONE) continue;
+    a.radius += RIPPLE_SPEED;
+    a.level   = qsub8(a.level, a.decay);
+    // A held ripple also ends once it has travelled off the strip
+    if(a.level == 0 || a.radius >= strip_length + RIPPLE_WIDTH) a.effect = NONE;
+  }
+
+  if(changed) FastLED.show();
+}
+
+#endif // EXTENSIBLE_UI
@@ -0,0 +1,111 @@
+/*********************
+ * ui_led_animator.h *
+ *********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_LED_ANIMATOR_H_
+#define _UI_LED_ANIMATOR_H_
+
+#include "ui_config.h"
+#include "ui_constexpr.h"
+#include "FastLED.h"
+
+/******************* LED ANIMATOR ************************/
+
+/* Writing to the NeoPixel strip disables interrupts for about half a
+ * millisecond, so it must not be done while a note is being struck.
+ * Instead, note_on() only records an effect, and the effects are
+ * rendered a frame at a time by onIdle(), which is meant to be run
+ * as a task every LED_FRAME_INTERVAL (see TaskScheduler). A frame is
+ * only sent to the strip when some pixel actually changed.
+ *
+ * Positions along the strip are given in sixteenths of a LED, so
+ * that a key can light up a point between two LEDs.
+ *
+ * Besides the effects, each of the LED_KEYS keys can be lit on its
+ * own LED with key_on() and key_off(). A held key stays lit in its
+ * color, and fades away once released; keys that share a LED add
+ * their colors, so a chord shows up as several colors at once. The
+ * LED for each key comes from a PROGMEM map, which by default spreads
+ * the keys evenly along the strip and may be replaced with set_key_map().
+ * Effects can be started from a key's own LED with key_position().
+ *
+ * An effect fades out over the length of its note. A note of unknown
+ * length, such as a key held on the touch panel, is started with a
+ * duration of zero and lasts until note_off() is given the id that
+ * note_on() returned.
+ */
+class LedAnimator {
+  public:
+    enum led_effect_t : uint8_t {
+      NONE,
+      RIPPLE   // A band of light travels outward from the key
+    };
+
+  private:
+    typedef struct {
+      CRGB         color;
+      uint16_t     origin;
+      uint16_t     radius;
+      uint8_t      level;
+      uint8_t      decay;     // Zero while held
+      uint8_t      id;
+      led_effect_t effect;
+    } animation_t;
+
+    static CRGB        leds[NUM_LEDS];
+    static animation_t animations[LED_ANIMATIONS];
+    static uint8_t     next_animation;
+    static uint8_t     next_id;
+
+    static CRGB           key_colors[LED_KEYS];
+    static uint8_t        key_levels[LED_KEYS];
+    static uint32_t       held_keys;
+    static const uint8_t *key_map;
+
+    static uint8_t intensity(const animation_t &a, uint16_t position);
+
+    template<typename> struct linear_map;
+    template<uint8_t... K> struct linear_map<UI::index_seq<K...>> {
+      static const uint8_t table[sizeof...(K)];
+    };
+
+  public:
+    static constexpr uint16_t strip_length = NUM_LEDS * 16;
+
+    static void init();
+    static uint8_t note_on(uint16_t position, CRGB color, led_effect_t effect, uint16_t duration_ms);
+    static void    note_off(uint8_t id);
+    static void clear();
+
+    static void key_on(uint8_t key, CRGB color);
+    static void key_off(uint8_t key);
+    static void set_key_map(const uint8_t *map);
+
+    // Returns the position along the strip of the center of a key's LED
+    static uint16_t key_position(uint8_t key) {return pgm_read_byte(&key_map[key]) * 16 + 8;}
+
+    static void onIdle();
+};
+
+template<uint8_t... K> const uint8_t LedAnimator::linear_map<UI::index_seq<K...>>::table[sizeof...(K)] PROGMEM = {
+  uint8_t(K * NUM_LEDS / LED_KEYS)...
+};
+
+#endif // _UI_LED_ANIMATOR_H_
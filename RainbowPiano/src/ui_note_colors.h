@@ -0,0 +1,112 @@
+/********************
+ * ui_note_colors.h *
+ ********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_NOTE_COLORS_H_
+#define _UI_NOTE_COLORS_H_
+
+#include "ftdi_eve_panels.h"
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_dl.h"
+
+#include "ui_theme.h"
+#include "ui_constexpr.h"
+
+/******************* NOTE COLORS ************************/
+
+/* Each note is given a color of the rainbow, from red for C to
+ * violet for B, with the sharps halfway between their neighbours.
+ * The colors for all 128 MIDI notes are computed at compile time
+ * into two PROGMEM tables: one corrected for the LCD (using the
+ * theme's COLOR_CORRECTION) and one gamma corrected for the
+ * WS2812 strip, which would otherwise wash out the blends.
+ */
+
+namespace NoteColors {
+  constexpr uint32_t red    = 0xFF0000;
+  constexpr uint32_t orange = 0xFF7F00;
+  constexpr uint32_t yellow = 0xFFFF00;
+  constexpr uint32_t green  = 0x00FF00;
+  constexpr uint32_t blue   = 0x0000FF;
+  constexpr uint32_t indigo = 0x4B0082;
+  constexpr uint32_t violet = 0x9400D3;
+
+  constexpr uint8_t channel(uint32_t rgb, uint8_t shift) {return (rgb >> shift) & 0xFF;}
+
+  // Averages two colors one channel at a time, so carries don't spill between channels
+  constexpr uint32_t blend(uint32_t a, uint32_t b) {
+    return (uint32_t((channel(a, 16) + channel(b, 16)) / 2) << 16) |
+           (uint32_t((channel(a,  8) + channel(b,  8)) / 2) <<  8) |
+           (uint32_t((channel(a,  0) + channel(b,  0)) / 2) <<  0);
+  }
+
+  constexpr uint32_t pitch_color(uint8_t pitch_class) {
+    return pitch_class ==  0 ? red                   : // C
+           pitch_class ==  1 ? blend(red,    orange) : // C#
+           pitch_class ==  2 ? orange                : // D
+           pitch_class ==  3 ? blend(orange, yellow) : // D#
+           pitch_class ==  4 ? yellow                : // E
+           pitch_class ==  5 ? green                 : // F
+           pitch_class ==  6 ? blend(green,  blue)   : // F#
+           pitch_class ==  7 ? blue                  : // G
+           pitch_class ==  8 ? blend(blue,   indigo) : // G#
+           pitch_class ==  9 ? indigo                : // A
+           pitch_class == 10 ? blend(indigo, violet) : // A#
+                               violet;                 // B
+  }
+
+  // WS2812 LEDs are linear in brightness, this approximates a gamma of 2
+  constexpr uint8_t gamma8(uint8_t c) {return (uint16_t(c) * c + 254) / 255;}
+
+  constexpr uint32_t lcd_color(uint8_t note) {return COLOR_CORRECTION(pitch_color(note % 12));}
+  constexpr uint8_t  led_channel(uint8_t note, uint8_t shift) {return gamma8(channel(pitch_color(note % 12), shift));}
+
+  template<typename> struct table;
+
+  template<uint8_t... N> struct table<UI::index_seq<N...>> {
+    static const uint32_t lcd[sizeof...(N)];
+    static const uint8_t  led[sizeof...(N)][3];
+  };
+
+  template<uint8_t... N> const uint32_t table<UI::index_seq<N...>>::lcd[sizeof...(N)] PROGMEM = {
+    lcd_color(N)...
+  };
+
+  template<uint8_t... N> const uint8_t table<UI::index_seq<N...>>::led[sizeof...(N)][3] PROGMEM = {
+    {led_channel(N, 16), led_channel(N, 8), led_channel(N, 0)}...
+  };
+
+  typedef table<UI::make_index_seq<128>::type> midi_table;
+
+  // Returns the color of a MIDI note for drawing on the LCD
+  inline uint32_t lcd(uint8_t note) {
+    return pgm_read_dword(&midi_table::lcd[note & 0x7F]);
+  }
+
+  // Returns the color of a MIDI note for the LED strip, as packed RGB
+  inline uint32_t led(uint8_t note) {
+    const uint8_t *rgb = midi_table::led[note & 0x7F];
+    return (uint32_t(pgm_read_byte(&rgb[0])) << 16) |
+           (uint32_t(pgm_read_byte(&rgb[1])) <<  8) |
+           (uint32_t(pgm_read_byte(&rgb[2])) <<  0);
+  }
+}
+
+#endif // _UI_NOTE_COLORS_H_
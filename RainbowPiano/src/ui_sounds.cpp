@@ -44,6 +44,21 @@ void tiny_timer_t::start() {
   _start = tiny_time_t::tiny_time(UI::safe_millis());
 }
 
+bool short_timer_t::elapsed(uint16_t interval) {
+  const uint16_t elapsed = uint16_t(UI::safe_millis()) - _start;
+  return elapsed >= interval;
+}
+
+void short_timer_t::start() {
+  _start = UI::safe_millis();
+}
+
+// Moves the start of the timer forward, for timing
+// periodic events without accumulating any delay.
+void short_timer_t::advance(uint16_t interval) {
+  _start += interval;
+}
+
 /******************* SOUND HELPER CLASS ************************/
 
 // Note: SOFT_DECAY does not seem to be necessary. If your
@@ -55,6 +70,9 @@ void tiny_timer_t::start() {
 namespace FTDI {
   SoundPlayer sound; // Global sound player object
 
+  SoundPlayer::note_observer_t *SoundPlayer::_note_observer = 0;
+  SoundPlayer::generator_t     *SoundPlayer::_generator     = 0;
+
   void SoundPlayer::set_volume(uint8_t vol) {
     CLCD::mem_write_8(REG_VOL_SOUND, vol);
   }
@@ -115,12 +133,14 @@ namespace FTDI {
 
     // Schedule silence to squelch the note after the duration expires.
     sequence = silence;
+    observed = false;
     wait = duration_ms;
     timer.start();
   }
 
   void SoundPlayer::play(const sound_t* seq, play_mode_t mode) {
     sequence = seq;
+    observed = true;
     wait     = 250; // Adding this delay causes the note to not be clipped, not sure why.
     timer.start();
 
@@ -141,7 +161,10 @@ namespace FTDI {
   }
 
   void SoundPlayer::onIdle() {
-    if(!sequence) return;
+    if(!sequence) {
+      if(_generator) _generator();
+      return;
+    }
 
     const bool ready_for_next_note = (wait == 0) ? !is_sound_playing() : timer.elapsed(wait);
 
@@ -153,11 +176,13 @@ namespace FTDI {
       if(ms == 0 && fx == SILENCE && nt == END_SONG) {
         sequence = 0;
         play(SILENCE, REST);
+        if(_note_observer && observed) _note_observer(SILENCE, REST, 0);
       } else {
         wait = ms;
         timer.start();
         play(fx, nt);
         sequence++;
+        if(_note_observer && observed) _note_observer(fx, nt, ms);
       }
     }
   }
@@ -60,6 +60,21 @@ class tiny_timer_t {
     bool elapsed(tiny_time_t interval);
 };
 
+/* short_timer_t keeps the lower 16 bits of millis(), which
+   gives it millisecond resolution over intervals of up to
+   a minute. Use it where tiny_timer_t is too coarse, such
+   as when polling input for a playable keyboard.
+ */
+class short_timer_t {
+  private:
+    uint16_t _start;
+
+  public:
+    void start();
+    void advance(uint16_t interval);
+    bool elapsed(uint16_t interval);
+};
+
 /******************* SOUND HELPER CLASS ************************/
 
 namespace FTDI {
@@ -78,11 +93,30 @@ namespace FTDI {
 
       const uint8_t WAIT = 0;
 
+      /* The note observer is told of every note played from a
+       * sequence, just after it is struck, so that the LEDs and
+       * the screen can follow along with a song. It is called
+       * with a note of REST when the song ends. The silence which
+       * play_tone() schedules is not a song and is not observed.
+       * The observer is called from onIdle() and must return quickly.
+       */
+      typedef void note_observer_t(effect_t effect, note_t note, uint16_t duration_ms);
+
+      /* The generator is called from onIdle() whenever no sequence is
+       * playing, so that sounds can be made up as they are needed, as
+       * by the drum sequencer.
+       */
+      typedef void generator_t();
+
     private:
       const sound_t   *sequence;
+      bool             observed;  // Whether the sequence is passed on to the note observer
       tiny_timer_t     timer;
       tiny_time_t      wait;
 
+      static note_observer_t *_note_observer;
+      static generator_t     *_generator;
+
       note_t frequency_to_midi_note(const uint16_t frequency);
 
     public:
@@ -96,6 +130,9 @@ namespace FTDI {
       void play_tone(const uint16_t frequency_hz, const uint16_t duration_ms);
       bool has_more_notes() {return sequence != 0;};
 
+      static void set_note_observer(note_observer_t *func) {_note_observer = func;}
+      static void set_generator(generator_t *func) {_generator = func;}
+
       void onIdle();
   };
 
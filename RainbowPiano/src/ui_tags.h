@@ -0,0 +1,119 @@
+/*************
+ * ui_tags.h *
+ *************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_TAGS_H_
+#define _UI_TAGS_H_
+
+#include "ui_constexpr.h"
+
+/**************************** TAG ALLOCATION **************************/
+
+/* The FT8xx tags are eight bits, of which 0 means "nothing touched" and
+ * 255 is the tag of anything drawn without one, leaving 254 per screen.
+ * Since only the current screen is touchable, each screen hands out its
+ * tags on its own, as consecutive ranges declared at compile time:
+ *
+ *   constexpr TagRange key_tags    = TagRange::first_range(88);
+ *   constexpr TagRange button_tags = key_tags.next(12);
+ *   constexpr TagRange volume_tag  = button_tags.next(1);
+ *
+ *   static_assert(UI::tags_valid(key_tags, button_tags, volume_tag), "Tags overlap or run out");
+ *
+ * tags_valid() fails to compile if any two ranges overlap or a range
+ * runs past tag 254, which catches ranges that were placed by hand.
+ * Widgets beyond the last tag can still be found by hit-testing (see
+ * WidgetTree::hit_test()).
+ *
+ * TagMap turns a tag back into the kind of widget it belongs to with
+ * a single read of a PROGMEM table, generated at compile time from a
+ * constexpr function M::widget_of(tag); the position of the widget in
+ * its range is then given by TagRange::index().
+ */
+
+class TagRange {
+  public:
+    static constexpr uint8_t max_tag = 254;
+
+    const uint8_t first;
+    const uint8_t count;
+
+    constexpr TagRange(uint8_t first, uint8_t count) : first(first), count(count) {}
+
+    // The first range on a screen starts at tag 1
+    static constexpr TagRange first_range(uint8_t count) {return TagRange(1, count);}
+
+    // The range which follows this one
+    constexpr TagRange next(uint8_t n) const {return TagRange(first + count, n);}
+
+    constexpr uint8_t operator[] (uint8_t i) const {return first + i;}
+    constexpr uint8_t last()                 const {return first + count - 1;}
+    constexpr uint8_t index(uint8_t tag)     const {return tag - first;}
+    constexpr bool    contains(uint8_t tag)  const {return tag >= first && tag - first < count;}
+
+    constexpr bool is_valid() const {
+      return first != 0 && uint16_t(first) + count - 1 <= max_tag;
+    }
+
+    constexpr bool overlaps(const TagRange &r) const {
+      return uint16_t(first) < uint16_t(r.first) + r.count && uint16_t(r.first) < uint16_t(first) + count;
+    }
+};
+
+namespace UI {
+  constexpr bool overlaps_any(const TagRange &) {return false;}
+
+  template<class... R>
+  constexpr bool overlaps_any(const TagRange &a, const TagRange &b, const R&... rest) {
+    return a.overlaps(b) || overlaps_any(a, rest...);
+  }
+
+  constexpr bool tags_valid() {return true;}
+
+  // True if every range is within 1 to 254 and none overlap
+  template<class... R>
+  constexpr bool tags_valid(const TagRange &a, const R&... rest) {
+    return a.is_valid() && !overlaps_any(a, rest...) && tags_valid(rest...);
+  }
+}
+
+template<class M, typename> struct tag_map_table;
+
+template<class M, uint8_t... I>
+struct tag_map_table<M, UI::index_seq<I...>> {
+  static const uint8_t widgets[sizeof...(I)];
+};
+
+template<class M, uint8_t... I>
+const uint8_t tag_map_table<M, UI::index_seq<I...>>::widgets[sizeof...(I)] PROGMEM = {M::widget_of(I)...};
+
+template<class M>
+class TagMap {
+  private:
+    typedef tag_map_table<M, typename UI::make_index_seq<TagRange::max_tag + 1>::type> table;
+
+  public:
+    // Returns M::widget_of(tag), or M::none for tag 255
+    static uint8_t lookup(uint8_t tag) {
+      return tag <= TagRange::max_tag ? pgm_read_byte(&table::widgets[tag]) : uint8_t(M::none);
+    }
+};
+
+#endif // _UI_TAGS_H_
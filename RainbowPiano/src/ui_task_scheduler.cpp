@@ -0,0 +1,115 @@
+/*************************
+ * ui_task_scheduler.cpp *
+ *************************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include "ui_task_scheduler.h"
+
+TaskScheduler::task_t TaskScheduler::tasks[TASK_SLOTS];
+uint8_t               TaskScheduler::num_tasks = 0;
+
+// Adds a task, keeping the table sorted by priority. Returns a handle
+// for looking up the task's stats, or 0xFF if all slots are taken.
+uint8_t TaskScheduler::add(task_func_t *func, uint8_t priority, uint16_t period, uint16_t budget_us) {
+  if(num_tasks == TASK_SLOTS) {
+    #if defined(UI_FRAMEWORK_DEBUG)
+      SERIAL_ECHO_START();
+      SERIAL_ECHOLNPGM("No free task slots");
+    #endif
+    return 0xFF;
+  }
+  // Tasks are never removed, so the count so far is a unique handle
+  const uint8_t handle = num_tasks++;
+  uint8_t id = handle;
+  for(; id > 0 && tasks[id - 1].priority > priority; id--)
+    tasks[id] = tasks[id - 1];
+
+  task_t &t   = tasks[id];
+  t.func      = func;
+  t.period    = period;
+  t.release   = UI::safe_millis();
+  t.budget_us = budget_us;
+  t.priority  = priority;
+  t.handle    = handle;
+  t.stats     = {0, 0, 0};
+  return handle;
+}
+
+const TaskScheduler::task_stats_t &TaskScheduler::stats(uint8_t handle) {
+  static const task_stats_t none = {0, 0, 0};
+  for(uint8_t i = 0; i < num_tasks; i++)
+    if(tasks[i].handle == handle) return tasks[i].stats;
+  return none;
+}
+
+void TaskScheduler::reset_stats() {
+  for(uint8_t i = 0; i < num_tasks; i++)
+    tasks[i].stats = {0, 0, 0};
+}
+
+bool TaskScheduler::is_due(const task_t &t, uint16_t now) {
+  return t.period == 0 || int16_t(now - t.release) >= 0;
+}
+
+void TaskScheduler::run(uint8_t id) {
+  task_t &t = tasks[id];
+
+  if(t.period) {
+    const uint16_t late = uint16_t(UI::safe_millis()) - t.release;
+    if(late > t.stats.worst_late) t.stats.worst_late = late;
+    // Release the task again one period on, or from now if it
+    // fell more than a period behind, so it does not run in bursts.
+    t.release = late >= t.period ? uint16_t(UI::safe_millis()) + t.period : t.release + t.period;
+  }
+
+  const uint32_t start = micros();
+  t.func();
+  const uint32_t elapsed = micros() - start;
+
+  const uint16_t us = min(elapsed, uint32_t(0xFFFF));
+  if(us > t.stats.worst_us) t.stats.worst_us = us;
+  if(us > t.budget_us) {
+    t.stats.overruns++;
+    #if defined(UI_FRAMEWORK_DEBUG)
+      SERIAL_ECHO_START();
+      SERIAL_ECHOPAIR("Task ", t.handle);
+      SERIAL_ECHOLNPAIR(" over budget, us: ", us);
+    #endif
+  }
+}
+
+void TaskScheduler::run_urgent() {
+  const uint16_t now = UI::safe_millis();
+  for(uint8_t i = 0; i < num_tasks && tasks[i].priority == PRIORITY_URGENT; i++)
+    if(is_due(tasks[i], now)) run(i);
+}
+
+void TaskScheduler::onIdle() {
+  for(uint8_t i = 0; i < num_tasks; i++) {
+    if(!is_due(tasks[i], UI::safe_millis())) continue;
+    run(i);
+    if(tasks[i].priority != PRIORITY_URGENT) run_urgent();
+  }
+}
+
+#endif // EXTENSIBLE_UI
@@ -0,0 +1,90 @@
+/***********************
+ * ui_task_scheduler.h *
+ ***********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_TASK_SCHEDULER_H_
+#define _UI_TASK_SCHEDULER_H_
+
+/******************* TASK SCHEDULER ************************/
+
+/* The TaskScheduler runs the work of the main loop as a set of
+ * cooperative tasks, each of which must return quickly. A task is
+ * added with a priority, a period in milliseconds (zero to run on
+ * every pass) and a budget in microseconds.
+ *
+ * Each pass of onIdle() runs the tasks that are due in order of
+ * priority, zero being the highest. PRIORITY_URGENT tasks, such as the one
+ * which starts the next note of a song, are also checked again after
+ * each of the other tasks, so that a slow redraw can delay a note by
+ * no more than the time it takes.
+ *
+ * add() returns a handle for looking up the task's stats, which stays
+ * the same when tasks of a higher priority are added after it.
+ *
+ * A periodic task is due once its release time has passed; how late
+ * it was started and how long it ran are recorded, and a run longer
+ * than its budget is counted as an overrun and, with UI_FRAMEWORK_DEBUG,
+ * reported on the serial port.
+ */
+
+class TaskScheduler {
+  public:
+    typedef void task_func_t();
+
+    enum : uint8_t {
+      PRIORITY_URGENT = 0,
+      PRIORITY_NORMAL = 1,
+      PRIORITY_LOW    = 2
+    };
+
+    struct task_stats_t {
+      uint16_t worst_us;   // Longest run
+      uint16_t worst_late; // Longest delay past a release time, in milliseconds
+      uint16_t overruns;   // Runs longer than the budget
+    };
+
+  private:
+    struct task_t {
+      task_func_t *func;
+      uint16_t     period;
+      uint16_t     release;
+      uint16_t     budget_us;
+      uint8_t      priority;
+      uint8_t      handle;    // Order in which the task was added
+      task_stats_t stats;
+    };
+
+    static task_t  tasks[TASK_SLOTS];
+    static uint8_t num_tasks;
+
+    static bool is_due(const task_t &t, uint16_t now);
+    static void run(uint8_t id);
+    static void run_urgent();
+
+  public:
+    static uint8_t add(task_func_t *func, uint8_t priority, uint16_t period = 0, uint16_t budget_us = 0xFFFF);
+
+    static const task_stats_t &stats(uint8_t handle);
+    static void reset_stats();
+
+    static void onIdle();
+};
+
+#endif // _UI_TASK_SCHEDULER_H_
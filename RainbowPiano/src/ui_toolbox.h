@@ -31,9 +31,22 @@
 
 #include "ui_framework.h"
 #include "ui_sounds.h"
+#include "ui_drum_kit.h"
 #include "ui_bitmaps.h"
+#include "ui_dl_cache.h"
+#include "ui_font_cache.h"
 #include "ui_builder.h"
+#include "ui_control_map.h"
+#include "ui_keyboard.h"
+#include "ui_widgets.h"
+#include "ui_tags.h"
 #include "ui_event_loop.h"
+#include "ui_velocity.h"
+#include "ui_frame_scheduler.h"
+#include "ui_transition.h"
+#include "ui_task_scheduler.h"
+#include "ui_led_animator.h"
+#include "ui_note_colors.h"
 
 namespace UI {
   void onStartup();
@@ -46,15 +59,7 @@ using namespace UI;
 class InterfaceScreen : public UIScreen {
   public:
     static void onRefresh(){
-      using namespace FTDI;
-      CLCD::CommandFifo cmd;
-      cmd.cmd(CMD_DLSTART);
-
-      current_screen.onRedraw(BOTH);
-
-      cmd.cmd(DL::DL_DISPLAY);
-      cmd.cmd(CMD_SWAP);
-      cmd.execute();
+      FrameScheduler::request(BOTH);
     }
 };
 
@@ -0,0 +1,111 @@
+/*********************
+ * ui_transition.cpp *
+ *********************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
+#include "ftdi_eve_panels.h"
+
+#include "ui_framework.h"
+#include "ui_builder.h"
+#include "ui_dl_cache.h"
+#include "ui_frame_scheduler.h"
+#include "ui_transition.h"
+
+using namespace FTDI;
+
+// The snapshot is kept in RGB565 above the bitmaps, taking 750 kB on an
+// 800x480 panel, and the new screen is cached in the last DLCache slot.
+#define SNAPSHOT_ADDR       (RAM_G + 0x10000)
+#define SNAPSHOT_HANDLE     14
+#define TRANSITION_DL_SLOT  (DL_CACHE_SLOTS - 1)
+#define TRANSITION_DL_SIZE  8192
+
+ScreenTransition::transition_t ScreenTransition::transition = NONE;
+uint32_t                       ScreenTransition::start_ms   = 0;
+bool                           ScreenTransition::cached     = false;
+
+void ScreenTransition::start(transition_t type) {
+  #if defined(USE_FTDI_FT810)
+    if(type == NONE) return;
+    // The screen showing now is copied out by the coprocessor, which
+    // works through it while the MCU goes on to the new screen.
+    CLCD::CommandFifo cmd;
+    cmd.snapshot2(RGB565, SNAPSHOT_ADDR, 0, 0, display_width, display_height);
+    cmd.execute();
+
+    transition = type;
+    start_ms   = millis();
+    cached     = false;
+  #endif
+}
+
+// Stamps the snapshot of the outgoing screen, progress going from 0 to 255
+void ScreenTransition::draw_snapshot(CLCD::CommandFifo &cmd, uint8_t progress) {
+  #if defined(USE_FTDI_FT810)
+    int16_t x = 0;
+    switch(transition) {
+      case SLIDE_LEFT:  x = -int32_t(display_width) * progress / 256; break;
+      case SLIDE_RIGHT: x =  int32_t(display_width) * progress / 256; break;
+      default: break;
+    }
+    cmd.cmd(SAVE_CONTEXT());
+    cmd.cmd(BITMAP_HANDLE(SNAPSHOT_HANDLE));
+    cmd.setbitmap(SNAPSHOT_ADDR, RGB565, display_width, display_height);
+    cmd.cmd(TAG_MASK(false));
+    cmd.cmd(COLOR_RGB(0xFFFFFF));
+    cmd.cmd(COLOR_A(transition == FADE ? 255 - progress : 255));
+    cmd.cmd(BEGIN(BITMAPS));
+    cmd.cmd(VERTEX2F(x * 16, 0));
+    cmd.cmd(RESTORE_CONTEXT());
+  #endif
+}
+
+// Draws a frame of the transition. Returns false once there is none to draw.
+bool ScreenTransition::paint(CLCD::CommandFifo &cmd) {
+  if(transition == NONE) return false;
+
+  const uint32_t elapsed = millis() - start_ms;
+  if(elapsed >= SCREEN_TRANSITION_DURATION) {
+    transition = NONE;
+    return false;
+  }
+
+  DLCache dlcache(TRANSITION_DL_SLOT);
+  if(cached) {
+    dlcache.append();
+  } else {
+    current_screen.onRedraw(BOTH);
+    // Without room to keep the new screen, it is simply redrawn on each frame
+    cached = dlcache.store(TRANSITION_DL_SIZE);
+  }
+
+  draw_snapshot(cmd, elapsed * 256 / SCREEN_TRANSITION_DURATION);
+
+  // Keep the animation going, one frame at a time
+  FrameScheduler::request(BOTH);
+  return true;
+}
+
+#endif // EXTENSIBLE_UI
@@ -0,0 +1,70 @@
+/*******************
+ * ui_transition.h *
+ *******************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_TRANSITION_H_
+#define _UI_TRANSITION_H_
+
+/******************* SCREEN TRANSITIONS ************************/
+
+/* When animations are enabled, ScreenStack asks for a transition as
+ * it changes screens. start() has the coprocessor copy the outgoing
+ * screen into RAM_G with CMD_SNAPSHOT2, then the FrameScheduler draws
+ * each frame of the animation through paint():
+ *
+ *   - The first frame draws the new screen and keeps its display
+ *     list in the DLCache.
+ *   - Every other frame appends that display list and stamps the
+ *     snapshot on top, slid sideways or faded out, which takes only
+ *     a handful of display list words.
+ *   - Once SCREEN_TRANSITION_DURATION has passed, the new screen is
+ *     redrawn as usual.
+ *
+ * Nothing waits on the animation: each frame asks the FrameScheduler
+ * for the next one. Changes to the new screen during the animation
+ * show up once it ends. CMD_SNAPSHOT2 is only available on the FT810
+ * and up, so screens change without animation on the FT800.
+ */
+
+class ScreenTransition {
+  public:
+    enum transition_t : uint8_t {
+      NONE,
+      SLIDE_LEFT,   // Outgoing screen slides off to the left
+      SLIDE_RIGHT,  // Outgoing screen slides off to the right
+      FADE          // Outgoing screen fades away
+    };
+
+  private:
+    static transition_t transition;
+    static uint32_t     start_ms;
+    static bool         cached;
+
+    static void draw_snapshot(CLCD::CommandFifo &cmd, uint8_t progress);
+
+  public:
+    static void start(transition_t type);
+    static void cancel() {transition = NONE;}
+    static bool is_running() {return transition != NONE;}
+
+    static bool paint(CLCD::CommandFifo &cmd);
+};
+
+#endif // _UI_TRANSITION_H_
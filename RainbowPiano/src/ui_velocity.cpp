@@ -0,0 +1,81 @@
+/*******************
+ * ui_velocity.cpp *
+ *******************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include "ui.h"
+
+#if ENABLED(EXTENSIBLE_UI)
+
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
+#include "ftdi_eve_panels.h"
+
+#include "ui_velocity.h"
+
+using namespace FTDI;
+
+// Number of RZ readings to average, as a power of two
+#define VELOCITY_OVERSAMPLE 2
+
+// The default curve never goes fully silent, so even the
+// lightest touch is audible, and rises quickly at first.
+PROGMEM const uint8_t default_velocity_curve[TouchVelocity::curve_points] = {
+  64, 104, 136, 162, 184, 204, 222, 239, 255
+};
+
+// A touch is only registered when RZ is below touch_threshold,
+// so that is the softest possible touch.
+uint16_t       TouchVelocity::rz_soft = touch_threshold;
+uint16_t       TouchVelocity::rz_hard = touch_threshold / 4;
+const uint8_t *TouchVelocity::curve   = default_velocity_curve;
+
+void TouchVelocity::set_curve(const uint8_t *pgm_curve) {
+  curve = pgm_curve ? pgm_curve : default_velocity_curve;
+}
+
+uint8_t TouchVelocity::sample() {
+  uint32_t rz = 0;
+  for(uint8_t i = 0; i < (1 << VELOCITY_OVERSAMPLE); i++) {
+    rz += CLCD::mem_read_16(REG_TOUCH_RZ);
+  }
+  return from_rz(rz >> VELOCITY_OVERSAMPLE);
+}
+
+uint8_t TouchVelocity::from_rz(uint16_t rz) {
+  // Position of the reading between the softest and hardest touch, 0 to 256
+  uint16_t t;
+  if(rz >= rz_soft || rz_soft <= rz_hard) {
+    t = 0;
+  } else if(rz <= rz_hard) {
+    t = 256;
+  } else {
+    t = (uint32_t(rz_soft - rz) << 8) / (rz_soft - rz_hard);
+  }
+
+  // Interpolate between the two nearest points on the curve
+  constexpr uint8_t segment = 256 / (curve_points - 1);
+  const uint8_t i = min(t / segment, curve_points - 2);
+  const uint8_t f = t - i * segment;
+  const uint8_t a = pgm_read_byte(&curve[i]);
+  const uint8_t b = pgm_read_byte(&curve[i + 1]);
+  return a + (int16_t(b - a) * f) / segment;
+}
+
+#endif // EXTENSIBLE_UI
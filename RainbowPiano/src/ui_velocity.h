@@ -0,0 +1,60 @@
+/*****************
+ * ui_velocity.h *
+ *****************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_VELOCITY_H_
+#define _UI_VELOCITY_H_
+
+/******************* TOUCH VELOCITY ************************/
+
+/* The resistive touch controller reports the resistance of a
+ * touch in REG_TOUCH_RZ, which drops as the panel is pressed
+ * harder. TouchVelocity turns that reading into a velocity
+ * from 0 (lightest) to 255 (hardest), which can then be used
+ * to scale the volume of a note as it is struck.
+ *
+ * The RZ readings that correspond to the lightest and hardest
+ * touch vary between panels and can be set with calibrate().
+ * Between those, the velocity is shaped by a curve of nine
+ * points in PROGMEM, which is linearly interpolated.
+ */
+class TouchVelocity {
+  public:
+    static constexpr uint8_t curve_points = 9;
+
+  private:
+    static uint16_t rz_soft, rz_hard;
+    static const uint8_t *curve;
+
+  public:
+    static void calibrate(uint16_t soft, uint16_t hard) {rz_soft = soft; rz_hard = hard;}
+    static void set_curve(const uint8_t *pgm_curve);
+
+    // Reads REG_TOUCH_RZ and maps it to a velocity
+    static uint8_t sample();
+    static uint8_t from_rz(uint16_t rz);
+
+    // Scales a volume by a velocity. The FT8xx has a single volume,
+    // REG_VOL_SOUND, for everything it plays, so a scaled volume also
+    // applies to any song or beat that is playing at the same time.
+    static uint8_t scale(uint8_t volume, uint8_t velocity) {return (uint16_t(volume) * (velocity + 1)) >> 8;}
+};
+
+#endif // _UI_VELOCITY_H_
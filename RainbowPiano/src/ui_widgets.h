@@ -0,0 +1,174 @@
+/****************
+ * ui_widgets.h *
+ ****************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#ifndef _UI_WIDGETS_H_
+#define _UI_WIDGETS_H_
+
+/**************************** RETAINED WIDGETS **************************/
+
+/* Most screens draw themselves by calling button() and text() for every
+ * widget on every redraw. A WidgetTree instead keeps a screen's widgets
+ * as a table of records in PROGMEM, for example:
+ *
+ *   const widget_t widgets[] PROGMEM = {
+ *     // type          group tag position        size            label
+ *     {WIDGET_TEXT,    0,    0,  BTN_POS(1,1),   BTN_SIZE(3,1),  title_str},
+ *     {WIDGET_BUTTON,  1,    2,  BTN_POS(1,2),   BTN_SIZE(1,1),  ok_str},
+ *     ...
+ *   };
+ *
+ *   static WidgetTree<num_widgets, 2> tree(widgets, first_dl_slot);
+ *
+ *   tree.draw(cmd);
+ *
+ * The widgets are drawn a group at a time. The display list of each
+ * group is kept in a DLCache slot (one per group, from first_dl_slot)
+ * and appended as is on later redraws, until something in the group
+ * changes: invalidate() a group whose look depends on screen state,
+ * such as a highlighted button, and only that group is drawn again.
+ * Groups are also drawn again while one of their buttons is pressed,
+ * and once after, so the button style callback can show the press.
+ *
+ * Each widget may be given a font of its own, fitted to its label
+ * with fit_font(), and may be hidden, which allows two widgets in the
+ * same place to stand for the states of one button.
+ *
+ * hit_test() finds the widget under a point without relying on tags,
+ * so widgets given tag 0 can still be touched, should a screen have
+ * more widgets than there are tags to go around.
+ */
+
+enum widget_type_t : uint8_t {
+  WIDGET_BUTTON,
+  WIDGET_TEXT
+};
+
+struct widget_t {
+  widget_type_t type;
+  uint8_t       group;  // Widgets in a group are cached and redrawn together
+  uint8_t       tag;    // Or 0 for none
+  int16_t       x, y;
+  int16_t       w, h;
+  const char   *label;  // PROGMEM string
+};
+
+template<uint8_t N, uint8_t GROUPS>
+class WidgetTree {
+  private:
+    static_assert(N <= 32,     "A WidgetTree holds no more than 32 widgets");
+    static_assert(GROUPS <= 8, "A WidgetTree holds no more than 8 groups");
+
+    // Room reserved in RAM_G for each group, so it can be stored again when it changes
+    static constexpr uint16_t group_dl_size = 2048;
+
+    const widget_t *widgets;
+    uint8_t  first_dl_slot;
+    uint8_t  dirty;        // One bit per group
+    uint8_t  pressed_group;
+    uint32_t hidden;       // One bit per widget
+    uint8_t  fonts[N];     // Or 0 to keep the current font
+
+    void read(uint8_t i, widget_t &w) const {memcpy_P(&w, &widgets[i], sizeof(w));}
+
+    void draw_group(CommandProcessor &cmd, uint8_t group) {
+      for(uint8_t i = 0; i < N; i++) {
+        widget_t w;
+        read(i, w);
+        if(w.group != group || !is_visible(i)) continue;
+        if(fonts[i]) cmd.font(fonts[i]);
+        cmd.tag(w.tag);
+        switch(w.type) {
+          case WIDGET_BUTTON: cmd.button(w.x, w.y, w.w, w.h, (progmem_str) w.label); break;
+          case WIDGET_TEXT:   cmd.text  (w.x, w.y, w.w, w.h, (progmem_str) w.label); break;
+        }
+      }
+    }
+
+  public:
+    WidgetTree(const widget_t *widgets, uint8_t first_dl_slot) :
+      widgets(widgets), first_dl_slot(first_dl_slot), dirty(0xFF), pressed_group(0xFF), hidden(0), fonts() {}
+
+    void invalidate(uint8_t group) {dirty |= 1 << group;}
+    void invalidate_all()          {dirty = 0xFF;}
+
+    bool is_visible(uint8_t i) const {return !(hidden & (uint32_t(1) << i));}
+
+    void show(uint8_t i, bool visible) {
+      if(visible == is_visible(i)) return;
+      hidden ^= uint32_t(1) << i;
+      invalidate(pgm_read_byte(&widgets[i].group));
+    }
+
+    void set_font(uint8_t i, uint8_t font) {fonts[i] = font;}
+
+    // Picks the largest font in which the label of widget i fits
+    void fit_font(uint8_t i, uint8_t largest, uint8_t smallest) {
+      widget_t w;
+      read(i, w);
+      fonts[i] = FontCache::fit_font((progmem_str) w.label, w.w, w.h, largest, smallest);
+    }
+
+    // Returns the group of the first widget with a tag, or 0xFF if none
+    uint8_t group_of(uint8_t tag) const {
+      for(uint8_t i = 0; tag && i < N; i++)
+        if(pgm_read_byte(&widgets[i].tag) == tag) return pgm_read_byte(&widgets[i].group);
+      return 0xFF;
+    }
+
+    void draw(CommandProcessor &cmd) {
+      // Redraw the groups holding the button being pressed and the one last pressed
+      const uint8_t group = group_of(get_pressed_tag());
+      if(pressed_group != 0xFF) invalidate(pressed_group);
+      if(group         != 0xFF) invalidate(group);
+      pressed_group = group;
+
+      for(uint8_t g = 0; g < GROUPS; g++) {
+        DLCache dlcache(first_dl_slot + g);
+        if(!(dirty & (1 << g)) && dlcache.has_data()) {
+          dlcache.append();
+          continue;
+        }
+        dlcache.begin_segment();
+        draw_group(cmd, g);
+        if(dlcache.store(group_dl_size)) dirty &= ~(1 << g);
+      }
+    }
+
+    // Returns the index of the topmost visible widget at x, y, or 0xFF if none
+    uint8_t hit_test(int16_t x, int16_t y) const {
+      for(uint8_t i = N; i-- > 0;) {
+        widget_t w;
+        read(i, w);
+        if(is_visible(i) && x >= w.x && x < w.x + w.w && y >= w.y && y < w.y + w.h) return i;
+      }
+      return 0xFF;
+    }
+
+    uint8_t hit_test() const {
+      int16_t x, y;
+      CLCD::get_touch_xy(x, y);
+      return hit_test(x, y);
+    }
+
+    uint8_t tag(uint8_t i) const {return pgm_read_byte(&widgets[i].tag);}
+};
+
+#endif // _UI_WIDGETS_H_
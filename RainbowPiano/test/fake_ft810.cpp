@@ -0,0 +1,137 @@
+/******************
+ * fake_ft810.cpp *
+ ******************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+#include <map>
+
+#include "ui.h"
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_spi.h"
+#include "fake_ft810.h"
+
+SPIClass SPI;
+void   (*test_interrupt_handler)();
+
+namespace FakeFT810 {
+  unsigned tag_reads;
+
+  static std::map<uint32_t, uint8_t> mem;   // Register bytes written so far
+  static std::map<uint32_t, unsigned> cmds;  // Words written to REG_CMDB_WRITE
+  static uint32_t                    cmd_word;
+  static uint8_t                     int_flags;
+  static bool                        int_n_level = true;
+
+  static uint32_t addr;
+  static uint8_t  byte_count;
+  static bool     is_write;
+
+  // INT_N is active low
+  static void update_int_n() {
+    using namespace FTDI;
+    const bool level = !((mem[REG_INT_EN] & 1) && (int_flags & mem[REG_INT_MASK]));
+    const bool falls = int_n_level && !level;
+    int_n_level = level;
+    if(falls && test_interrupt_handler) test_interrupt_handler();
+  }
+
+  static uint8_t read(uint32_t a) {
+    using namespace FTDI;
+    switch(a) {
+      case REG_TOUCH_TAG: tag_reads++; break;
+      case REG_INT_FLAGS: {
+        const uint8_t flags = int_flags;
+        int_flags = 0;
+        update_int_n();
+        return flags;
+      }
+    }
+    return peek(a);
+  }
+
+  uint8_t peek(uint32_t a) {
+    using namespace FTDI;
+    // The panel shows a new frame every 16 ms
+    if(a >= REG_FRAMES && a < REG_FRAMES + 4)
+      return (millis() / 16) >> (8 * (a - REG_FRAMES));
+    switch(a) {
+      case REG_ID:             return 0x7C;
+      case REG_CMDB_SPACE:     return 0xFC;
+      case REG_CMDB_SPACE + 1: return 0x0F;
+    }
+    return mem[a];
+  }
+
+  void write(uint32_t a, uint8_t val) {
+    mem[a] = val;
+  }
+
+  unsigned cmd_count(uint32_t word) {return cmds[word];}
+
+  // Every byte written to REG_CMDB_WRITE goes to the same address
+  static void write_cmd(uint8_t i, uint8_t val) {
+    cmd_word = (cmd_word >> 8) | uint32_t(val) << 24;
+    if(i % 4 == 3) cmds[cmd_word]++;
+  }
+
+  bool int_n() {return int_n_level;}
+
+  void touch(uint8_t tag) {
+    mem[FTDI::REG_TOUCH_TAG] = tag;
+    int_flags |= tag ? FTDI::INT_TOUCH | FTDI::INT_TAG : FTDI::INT_TOUCH;
+    update_int_n();
+  }
+
+  static uint8_t transfer(uint8_t val) {
+    const uint8_t i = byte_count++;
+    if(i == 0) is_write = val & 0x80;
+    if(i < 3) {
+      addr = (addr << 8) | (i == 0 ? val & 0x3F : val);
+      return 0;
+    }
+    if(is_write) {
+      if(addr == FTDI::REG_CMDB_WRITE) write_cmd(i - 3, val);
+      else                             write(addr + i - 3, val);
+      return 0;
+    }
+    return i == 3 ? 0 : read(addr + i - 4); // Skip the dummy byte
+  }
+}
+
+uint8_t test_spi_transfer(uint8_t val) {
+  return FakeFT810::transfer(val);
+}
+
+namespace FTDI {
+  namespace SPI {
+    void spi_init()           {}
+    void ftdi_reset()         {}
+    void spi_ftdi_select()    {FakeFT810::addr = 0; FakeFT810::byte_count = 0;}
+    void spi_ftdi_deselect()  {FakeFT810::update_int_n();}
+    void spi_read_bulk(void *data, uint16_t len) {
+      uint8_t *p = (uint8_t*) data;
+      while(len--) *p++ = spi_recv();
+    }
+    bool spi_verify_bulk(const void *data, uint16_t len) {
+      const uint8_t *p = (const uint8_t*) data;
+      while(len--) if(*p++ != spi_recv()) return false;
+      return true;
+    }
+  }
+}
@@ -0,0 +1,52 @@
+/****************
+ * fake_ft810.h *
+ ****************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+/* A make-believe FT810 on the other end of the SPI stub, for the
+ * tests of the event loop. Registers read back what was written to
+ * them, REG_ID reads 0x7C, REG_FRAMES counts a frame every 16 ms and
+ * the command buffer always has room. The
+ * words written to the command buffer are counted but not carried out.
+ *
+ * INT_N goes low while any of the flags in REG_INT_FLAGS is enabled
+ * by REG_INT_MASK and REG_INT_EN, calling the handler attached to it
+ * as it falls, and is released when REG_INT_FLAGS is read.
+ */
+
+#ifndef _FAKE_FT810_H_
+#define _FAKE_FT810_H_
+
+#include <stdint.h>
+
+namespace FakeFT810 {
+  extern unsigned tag_reads;      // Reads of REG_TOUCH_TAG
+
+  // Number of times a word was written to the command buffer
+  unsigned cmd_count(uint32_t word);
+
+  void    write(uint32_t addr, uint8_t val);
+  uint8_t peek(uint32_t addr);    // Reads without side effects
+  bool    int_n();
+
+  // Puts a finger on a tag, or lifts it with zero
+  void    touch(uint8_t tag);
+}
+
+#endif // _FAKE_FT810_H_
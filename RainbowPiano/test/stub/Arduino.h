@@ -0,0 +1,65 @@
+/*************
+ * Arduino.h *
+ *************/
+
+/* Just enough of the Arduino core to build parts of the
+ * sketch on the host for the tests in this directory.
+ */
+
+#ifndef _TEST_ARDUINO_H_
+#define _TEST_ARDUINO_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stddef.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) ((const __FlashStringHelper*)(s))
+class __FlashStringHelper;
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+inline uint8_t  pgm_read_byte (const void *p) {return *(const uint8_t*)  p;}
+inline uint16_t pgm_read_word (const void *p) {return *(const uint16_t*) p;}
+inline uint32_t pgm_read_dword(const void *p) {return *(const uint32_t*) p;}
+inline void*    pgm_read_ptr  (const void *p) {return *(void* const*)    p;}
+inline void*    memcpy_P(void *d, const void *s, size_t n) {return memcpy(d, s, n);}
+inline size_t   strlen_P(const char *s) {return strlen(s);}
+
+// The tests set the time by hand
+extern unsigned long test_millis;
+inline unsigned long millis()                    {return test_millis;}
+inline unsigned long micros()                    {return test_millis * 1000;}
+inline void          delay(unsigned long ms)     {test_millis += ms;}
+inline void          delayMicroseconds(unsigned) {}
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+#define LOW          0
+#define HIGH         1
+#define FALLING      2
+
+inline void pinMode(uint8_t, uint8_t)      {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int  digitalRead(uint8_t)           {return HIGH;}
+#define digitalPinToInterrupt(p) (p)
+
+// A test fires an interrupt by calling the handler attached to it
+extern void (*test_interrupt_handler)();
+inline void attachInterrupt(uint8_t, void(*isr)(), int) {test_interrupt_handler = isr;}
+
+struct SerialClass {
+  template<class T> void print(T)   {}
+  template<class T> void println(T) {}
+};
+extern SerialClass Serial;
+
+#endif // _TEST_ARDUINO_H_
@@ -0,0 +1,54 @@
+/*************
+ * FastLED.h *
+ *************/
+
+/* A stand-in for FastLED which keeps the last frame shown
+ * and counts the frames, for the tests in this directory.
+ */
+
+#ifndef _TEST_FASTLED_H_
+#define _TEST_FASTLED_H_
+
+#include <stdint.h>
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) {return (uint16_t(i) * (1 + scale)) >> 8;}
+inline uint8_t qadd8 (uint8_t i, uint8_t j)     {return uint16_t(i) + j > 255 ? 255 : i + j;}
+inline uint8_t qsub8 (uint8_t i, uint8_t j)     {return i > j ? i - j : 0;}
+
+struct CRGB {
+  uint8_t r, g, b;
+
+  enum : uint32_t {
+    Black = 0x000000,
+    White = 0xFFFFFF,
+    Red   = 0xFF0000,
+    Green = 0x00FF00,
+    Blue  = 0x0000FF
+  };
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint32_t rgb) : r(rgb >> 16), g(rgb >> 8), b(rgb) {}
+  CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+
+  CRGB& operator+= (const CRGB &c) {r = qadd8(r, c.r); g = qadd8(g, c.g); b = qadd8(b, c.b); return *this;}
+  CRGB& nscale8(uint8_t scale)     {r = scale8(r, scale); g = scale8(g, scale); b = scale8(b, scale); return *this;}
+
+  bool operator== (const CRGB &c) const {return r == c.r && g == c.g && b == c.b;}
+  bool operator!= (const CRGB &c) const {return !(*this == c);}
+};
+
+enum {NEOPIXEL};
+
+struct CFastLED {
+  CRGB     *leds     = nullptr;
+  int       num_leds = 0;
+  unsigned  shows    = 0;
+
+  template<int TYPE, int PIN> CFastLED& addLeds(CRGB *l, int n) {leds = l; num_leds = n; return *this;}
+  void setBrightness(uint8_t) {}
+  void show() {shows++;}
+};
+
+extern CFastLED FastLED;
+
+#endif // _TEST_FASTLED_H_
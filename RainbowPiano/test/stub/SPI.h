@@ -0,0 +1,35 @@
+/*********
+ * SPI.h *
+ *********/
+
+/* Hands each byte to test_spi_transfer(), so that a test can stand
+ * in for the device on the other end of the bus.
+ */
+
+#ifndef _TEST_SPI_H_
+#define _TEST_SPI_H_
+
+#include <stdint.h>
+
+#define MSBFIRST   1
+#define SPI_MODE0  0
+
+uint8_t test_spi_transfer(uint8_t val);
+
+struct SPISettings {
+  SPISettings() {}
+  SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+  public:
+    void    begin()                        {}
+    void    end()                          {}
+    void    beginTransaction(SPISettings)  {}
+    void    endTransaction()               {}
+    uint8_t transfer(uint8_t val)          {return test_spi_transfer(val);}
+};
+
+extern SPIClass SPI;
+
+#endif // _TEST_SPI_H_
@@ -0,0 +1,3 @@
+#ifndef _TEST_WIRE_H_
+#define _TEST_WIRE_H_
+#endif
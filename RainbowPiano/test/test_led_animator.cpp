@@ -0,0 +1,230 @@
+/*************************
+ * test_led_animator.cpp *
+ *************************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+/* Renders LED frames on the host for a sequence of notes, to check
+ * that held keys light the LED they are mapped to, that chords show
+ * several colors at once, and that the strip is only written to when
+ * a frame changes.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "ui.h"
+#include "ftdi_eve_constants.h"
+#include "ftdi_eve_functions.h"
+#include "ui_led_animator.h"
+
+unsigned long test_millis = 0;
+SerialClass   Serial;
+CFastLED      FastLED;
+
+static int failures = 0;
+
+#define CHECK(cond) do { if(!(cond)) { printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+static uint8_t led_of(uint8_t key) {return (LedAnimator::key_position(key) - 8) / 16;}
+
+// Renders one frame, returning whether it was sent to the strip
+static bool frame() {
+  const unsigned shows = FastLED.shows;
+  test_millis += LED_FRAME_INTERVAL;
+  LedAnimator::onIdle();
+  return FastLED.shows != shows;
+}
+
+static bool is_black(const CRGB &c) {return c == CRGB(CRGB::Black);}
+
+static void test_key_map() {
+  for(uint8_t k = 0; k < LED_KEYS; k++) {
+    CHECK(led_of(k) < NUM_LEDS);
+    CHECK(led_of(k) == k * NUM_LEDS / LED_KEYS);
+    if(k) CHECK(led_of(k) >= led_of(k - 1));
+  }
+}
+
+static void test_chord() {
+  LedAnimator::clear();
+  frame();
+
+  // C, E and G of the first octave land on three different LEDs
+  const uint8_t c = 0, e = 4, g = 7;
+  CHECK(led_of(c) != led_of(e) && led_of(e) != led_of(g));
+
+  LedAnimator::key_on(c, CRGB::Red);
+  LedAnimator::key_on(e, CRGB::Green);
+  LedAnimator::key_on(g, CRGB::Blue);
+  CHECK(frame());
+
+  for(uint8_t i = 0; i < NUM_LEDS; i++) {
+    const CRGB &led = FastLED.leds[i];
+    if     (i == led_of(c)) CHECK(led == CRGB(CRGB::Red));
+    else if(i == led_of(e)) CHECK(led == CRGB(CRGB::Green));
+    else if(i == led_of(g)) CHECK(led == CRGB(CRGB::Blue));
+    else                    CHECK(is_black(led));
+  }
+
+  // Held keys do not change, so nothing more is sent to the strip
+  CHECK(!frame());
+  CHECK(!frame());
+
+  // A released key fades away from the next frame on, while the others stay lit
+  LedAnimator::key_off(e);
+  frame();
+  uint8_t last = 255;
+  uint8_t frames = 0;
+  while(frame()) {
+    CHECK(FastLED.leds[led_of(e)].g < last);
+    CHECK(FastLED.leds[led_of(c)] == CRGB(CRGB::Red));
+    CHECK(FastLED.leds[led_of(g)] == CRGB(CRGB::Blue));
+    last = FastLED.leds[led_of(e)].g;
+    frames++;
+  }
+  CHECK(is_black(FastLED.leds[led_of(e)]));
+  CHECK(frames <= 300 / LED_FRAME_INTERVAL + 1);
+}
+
+static void test_shared_led() {
+  LedAnimator::clear();
+  frame();
+
+  // With more keys than LEDs, some keys share a LED and add their colors
+  uint8_t a = 0, b = 1;
+  while(led_of(b) != led_of(a) && b < LED_KEYS - 1) {a++; b++;}
+  CHECK(led_of(a) == led_of(b));
+
+  LedAnimator::key_on(a, CRGB::Red);
+  LedAnimator::key_on(b, CRGB::Blue);
+  frame();
+  CHECK(FastLED.leds[led_of(a)] == CRGB(0xFF00FF));
+}
+
+static void test_ripple() {
+  LedAnimator::clear();
+  frame();
+
+  // A ripple starts at the key's own LED and travels outward
+  const uint8_t key = LED_KEYS / 2;
+  LedAnimator::note_on(LedAnimator::key_position(key), CRGB::White, LedAnimator::RIPPLE, 800);
+  CHECK(frame());
+  CHECK(!is_black(FastLED.leds[led_of(key)]));
+  CHECK(is_black(FastLED.leds[0]));
+
+  uint8_t frames = 1;
+  while(frame()) frames++;
+  for(uint8_t i = 0; i < NUM_LEDS; i++) CHECK(is_black(FastLED.leds[i]));
+  CHECK(frames <= 800 / LED_FRAME_INTERVAL + 1);
+}
+
+// Returns the brightest channel of the brightest LED
+static uint8_t brightest() {
+  uint8_t m = 0;
+  for(uint8_t i = 0; i < NUM_LEDS; i++) {
+    const CRGB &c = FastLED.leds[i];
+    m = max(m, max(c.r, max(c.g, c.b)));
+  }
+  return m;
+}
+
+static void test_note_length() {
+  // A ripple fades out over the length of its note, so a long note
+  // is still bright when a short one has nearly gone
+  uint8_t level[2], frames[2];
+  const uint16_t lengths[2] = {400, 1600};
+  for(uint8_t n = 0; n < 2; n++) {
+    LedAnimator::clear();
+    frame();
+    LedAnimator::note_on(LedAnimator::key_position(LED_KEYS / 2), CRGB::White, LedAnimator::RIPPLE, lengths[n]);
+    for(uint8_t i = 0; i < 300 / LED_FRAME_INTERVAL; i++) frame();
+    level[n] = brightest();
+    frames[n] = 300 / LED_FRAME_INTERVAL;
+    while(frame()) frames[n]++;
+  }
+  CHECK(level[0] < 96);
+  CHECK(level[1] > 128);
+  CHECK(frames[0] <= 400 / LED_FRAME_INTERVAL + 3);
+}
+
+static void test_held_ripple() {
+  LedAnimator::clear();
+  frame();
+
+  // A ripple with no length stays at full brightness while held,
+  // allowing for the band falling between two LEDs
+  const uint8_t id = LedAnimator::note_on(LedAnimator::key_position(LED_KEYS / 2), CRGB::White, LedAnimator::RIPPLE, 0);
+  for(uint8_t i = 0; i < 10; i++) frame();
+  CHECK(brightest() > 180);
+
+  // An id that has made way for a newer effect does nothing
+  for(uint8_t i = 0; i < LED_ANIMATIONS; i++)
+    LedAnimator::note_on(LedAnimator::key_position(LED_KEYS / 2), CRGB::White, LedAnimator::RIPPLE, 0);
+  LedAnimator::note_off(id);
+  for(uint8_t i = 0; i < 5; i++) frame();
+  CHECK(brightest() > 180);
+
+  // Once released, it fades away like a key
+  LedAnimator::clear();
+  frame();
+  const uint8_t held = LedAnimator::note_on(LedAnimator::key_position(LED_KEYS / 2), CRGB::White, LedAnimator::RIPPLE, 0);
+  frame();
+  LedAnimator::note_off(held);
+  uint8_t frames = 0;
+  while(frame()) frames++;
+  CHECK(brightest() == 0);
+  CHECK(frames <= 300 / LED_FRAME_INTERVAL + 1);
+
+  // A held ripple that has travelled off the strip is done with
+  LedAnimator::note_on(0, CRGB::White, LedAnimator::RIPPLE, 0);
+  for(uint16_t i = 0; i < 200; i++) frame();
+  CHECK(brightest() == 0);
+  CHECK(!frame());
+}
+
+static void test_frame_cost() {
+  LedAnimator::clear();
+  for(uint8_t k = 0; k < LED_KEYS; k += 2) LedAnimator::key_on(k, CRGB::White);
+  for(uint8_t i = 0; i < LED_ANIMATIONS; i++)
+    LedAnimator::note_on(LedAnimator::key_position(i * 4), CRGB::White, LedAnimator::RIPPLE, 10000);
+
+  constexpr unsigned n = 10000;
+  const clock_t start = clock();
+  for(unsigned i = 0; i < n; i++) {
+    test_millis += LED_FRAME_INTERVAL;
+    LedAnimator::onIdle();
+  }
+  const double us = double(clock() - start) * 1e6 / CLOCKS_PER_SEC / n;
+  printf("LedAnimator::onIdle(): %.2f us per frame on the host, %u keys and %u effects\n", us, LED_KEYS, LED_ANIMATIONS);
+}
+
+int main() {
+  LedAnimator::init();
+
+  test_key_map();
+  test_chord();
+  test_shared_led();
+  test_ripple();
+  test_note_length();
+  test_held_ripple();
+  test_frame_cost();
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
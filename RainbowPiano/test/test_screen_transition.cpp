@@ -0,0 +1,99 @@
+/******************************
+ * test_screen_transition.cpp *
+ ******************************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+/* Changes screens with animations enabled, as the sketch does from
+ * setup(), to check that each change snapshots the outgoing screen,
+ * animates for SCREEN_TRANSITION_DURATION and then ends, and that
+ * screens change at once with animations disabled.
+ */
+
+#include <stdio.h>
+
+#include "ui.h"
+#include "ui_toolbox.h"
+#include "fake_ft810.h"
+
+unsigned long test_millis = 0;
+SerialClass   Serial;
+
+static int failures = 0;
+
+#define CHECK(cond) do { if(!(cond)) { printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+class FirstScreen : public InterfaceScreen {
+  public:
+    static void onRedraw(draw_mode_t) {}
+};
+
+class SecondScreen : public InterfaceScreen {
+  public:
+    static unsigned redraws;
+    static void onRedraw(draw_mode_t) {redraws++;}
+};
+
+unsigned SecondScreen::redraws;
+
+SCREEN_TABLE(FirstScreen, SecondScreen)
+
+static void run(uint16_t ms) {
+  for(uint16_t i = 0; i < ms; i++) {
+    test_millis++;
+    UI::onIdle();
+  }
+}
+
+static unsigned snapshots() {return FakeFT810::cmd_count(FTDI::CMD_SNAPSHOT2);}
+
+int main() {
+  UIData::enable_animations(true);
+  UI::onStartup();
+  run(100);
+  CHECK(!ScreenTransition::is_running());
+  CHECK(snapshots() == 0);
+
+  // Going to a screen snapshots the old one and slides it away
+  GOTO_SCREEN(SecondScreen);
+  CHECK(ScreenTransition::is_running());
+  CHECK(snapshots() == 1);
+  run(SCREEN_TRANSITION_DURATION / 2);
+  CHECK(ScreenTransition::is_running());
+  CHECK(SecondScreen::redraws > 0);
+  run(SCREEN_TRANSITION_DURATION);
+  CHECK(!ScreenTransition::is_running());
+  CHECK(AT_SCREEN(SecondScreen));
+
+  // Going back does the same
+  GOTO_PREVIOUS();
+  CHECK(ScreenTransition::is_running());
+  CHECK(snapshots() == 2);
+  run(SCREEN_TRANSITION_DURATION * 2);
+  CHECK(!ScreenTransition::is_running());
+  CHECK(AT_SCREEN(FirstScreen));
+
+  // Without animations, screens change at once
+  UIData::enable_animations(false);
+  GOTO_SCREEN(SecondScreen);
+  CHECK(!ScreenTransition::is_running());
+  CHECK(snapshots() == 2);
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+/****************************
+ * test_touch_interrupt.cpp *
+ ****************************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+/* Runs the event loop, built with USE_TOUCH_INTERRUPTS, against the
+ * make-believe FT810 in "fake_ft810.h". Checks that REG_TOUCH_TAG is
+ * left alone while INT_N is idle and that a touch is seen on the first
+ * pass of the event loop after the line falls.
+ */
+
+#include <stdio.h>
+
+#include "ui.h"
+#include "ui_toolbox.h"
+#include "fake_ft810.h"
+
+#if !defined(USE_TOUCH_INTERRUPTS)
+  #error "Build this test with -DUSE_TOUCH_INTERRUPTS"
+#endif
+
+unsigned long test_millis = 0;
+SerialClass   Serial;
+
+static int failures = 0;
+
+#define CHECK(cond) do { if(!(cond)) { printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+/********************************* TEST SCREEN **********************************/
+
+class TouchScreen : public InterfaceScreen {
+  public:
+    static constexpr uint8_t inputProfile = MUSICAL_INPUT_PROFILE;
+
+    static uint8_t starts, last_tag;
+
+    static void onRedraw(draw_mode_t) {}
+    static bool onTouchStart(uint8_t tag) {starts++; last_tag = tag; return true;}
+};
+
+uint8_t TouchScreen::starts;
+uint8_t TouchScreen::last_tag;
+
+SCREEN_TABLE(TouchScreen)
+
+static void pass() {
+  test_millis++;
+  UI::onIdle();
+}
+
+int main() {
+  UI::onStartup();
+  CHECK(test_interrupt_handler != NULL);
+  CHECK(FakeFT810::peek(FTDI::REG_INT_EN) == 1);
+  CHECK(FakeFT810::peek(FTDI::REG_INT_MASK) & FTDI::INT_TAG);
+
+  // The first pass reads the touch registers once, in case a touch
+  // was signalled before the interrupt was attached
+  pass();
+  CHECK(FakeFT810::tag_reads == 1);
+
+  // While INT_N stays high, REG_TOUCH_TAG is never read
+  FakeFT810::tag_reads = 0;
+  for(int i = 0; i < 1000; i++) pass();
+  CHECK(FakeFT810::int_n());
+  CHECK(FakeFT810::tag_reads == 0);
+  CHECK(TouchScreen::starts == 0);
+
+  // The line falls on a touch and the next pass sees it
+  FakeFT810::touch(5);
+  CHECK(!FakeFT810::int_n());
+  pass();
+  CHECK(TouchScreen::starts == 1);
+  CHECK(TouchScreen::last_tag == 5);
+  CHECK(FakeFT810::int_n());  // Released by reading REG_INT_FLAGS
+
+  // While held, the tag is polled without waiting on the line
+  FakeFT810::tag_reads = 0;
+  for(int i = 0; i < 10; i++) pass();
+  CHECK(FakeFT810::tag_reads > 0);
+
+  // Once released and debounced, the line is waited on again
+  FakeFT810::touch(0);
+  for(int i = 0; i < 100; i++) pass();
+  CHECK(!is_touch_held());
+  FakeFT810::tag_reads = 0;
+  for(int i = 0; i < 1000; i++) pass();
+  CHECK(FakeFT810::tag_reads == 0);
+
+  FakeFT810::touch(7);
+  pass();
+  CHECK(TouchScreen::starts == 2);
+  CHECK(TouchScreen::last_tag == 7);
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+/************************
+ * test_touch_slide.cpp *
+ ************************/
+
+/****************************************************************************
+ *   (c) 2018 Marcio Teixeira                                               *
+ *                                                                          *
+ *   This program is free software: you can redistribute it and/or modify   *
+ *   it under the terms of the GNU General Public License as published by   *
+ *   the Free Software Foundation, either version 3 of the License, or      *
+ *   (at your option) any later version.                                    *
+ *                                                                          *
+ *   This program is distributed in the hope that it will be useful,        *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   To view a copy of the GNU General Public License, go to the following  *
+ *   location: <http://www.gnu.org/licenses/>.                              *
+ ****************************************************************************/
+
+/* Slides a touch around a screen laid out like the piano screen, to
+ * check that a held touch slides from key to key, but not from a key
+ * onto the scrollbar above the keyboard, nor from the drum kit button
+ * onto the "..." button next to it.
+ */
+
+#include <stdio.h>
+
+#include "ui.h"
+#include "ui_toolbox.h"
+#include "fake_ft810.h"
+
+unsigned long test_millis = 0;
+SerialClass   Serial;
+
+static int failures = 0;
+
+#define CHECK(cond) do { if(!(cond)) { printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+constexpr TagRange key_tags   = TagRange::first_range(12);
+constexpr TagRange drums_tag  = key_tags.next(1);
+constexpr TagRange songs_tag  = drums_tag.next(1);
+constexpr TagRange scroll_tag = songs_tag.next(1);
+
+class KeysScreen : public InterfaceScreen {
+  public:
+    static constexpr uint8_t inputProfile = MUSICAL_INPUT_PROFILE;
+
+    static uint8_t starts[256], ends[256];
+
+    static void onRedraw(draw_mode_t) {}
+    static bool onTouchStart(uint8_t tag) {starts[tag]++; return true;}
+    static bool onTouchEnd(uint8_t tag)   {ends[tag]++;   return true;}
+    static bool isSlideTag(uint8_t tag)   {return key_tags.contains(tag);}
+};
+
+uint8_t KeysScreen::starts[256];
+uint8_t KeysScreen::ends[256];
+
+SCREEN_TABLE(KeysScreen)
+
+// Runs the event loop for a while with the finger on a tag, or lifted
+static void hold(uint8_t tag, uint16_t ms) {
+  FakeFT810::touch(tag);
+  for(uint16_t i = 0; i < ms; i++) {
+    test_millis++;
+    UI::onIdle();
+  }
+}
+
+static void test_key_to_key() {
+  hold(key_tags[0], 50);
+  CHECK(KeysScreen::starts[key_tags[0]] == 1);
+
+  // Sliding onto the next key strikes it and lets go of the first
+  hold(key_tags[1], 50);
+  CHECK(KeysScreen::ends[key_tags[0]]   == 1);
+  CHECK(KeysScreen::starts[key_tags[1]] == 1);
+
+  hold(0, 100);
+  CHECK(KeysScreen::ends[key_tags[1]] == 1);
+  CHECK(!is_touch_held());
+}
+
+static void test_key_to_scrollbar() {
+  // Sliding up off the keys leaves the key held, and does not start
+  // dragging the scrollbar
+  hold(key_tags[5], 50);
+  hold(scroll_tag.first, 100);
+  CHECK(KeysScreen::starts[scroll_tag.first] == 0);
+  CHECK(KeysScreen::ends[key_tags[5]] == 0);
+  CHECK(get_pressed_tag() == key_tags[5]);
+
+  hold(0, 100);
+  CHECK(KeysScreen::ends[key_tags[5]] == 1);
+}
+
+static void test_drums_to_songs() {
+  // Sliding off the drum kit onto "..." must not go to the songs screen
+  hold(drums_tag.first, 50);
+  CHECK(KeysScreen::starts[drums_tag.first] == 1);
+  hold(songs_tag.first, 100);
+  CHECK(KeysScreen::starts[songs_tag.first] == 0);
+
+  hold(0, 100);
+  CHECK(KeysScreen::ends[drums_tag.first] == 1);
+  CHECK(KeysScreen::ends[songs_tag.first] == 0);
+}
+
+int main() {
+  UI::onStartup();
+
+  test_key_to_key();
+  test_key_to_scrollbar();
+  test_drums_to_songs();
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}